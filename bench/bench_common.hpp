@@ -0,0 +1,328 @@
+#ifndef NUMERIC_RANGE_BENCH_COMMON_HPP
+#define NUMERIC_RANGE_BENCH_COMMON_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+// Counts user-space instructions retired by this thread via perf_event_open.
+// Unavailable (e.g. in most VMs and containers) when valid() is false.
+class InstructionCounter
+{
+public:
+  InstructionCounter ()
+  {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+
+  InstructionCounter (const InstructionCounter &) = delete;
+  InstructionCounter &operator= (const InstructionCounter &) = delete;
+
+  ~InstructionCounter ()
+  {
+#ifdef __linux__
+    if (fd_ >= 0)
+    {
+      close(fd_);
+    }
+#endif
+  }
+
+  bool valid () const { return fd_ >= 0; }
+
+  void
+  start ()
+  {
+#ifdef __linux__
+    if (fd_ >= 0)
+    {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  // Instructions since start(), or -1 if unavailable
+  double
+  stop ()
+  {
+    long long count = -1;
+#ifdef __linux__
+    if (fd_ >= 0)
+    {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd_, &count, sizeof(count)) != sizeof(count))
+      {
+        count = -1;
+      }
+    }
+#endif
+    return double(count);
+  }
+
+private:
+  int fd_ = -1;
+};
+
+// How benchmark keys are spread over the n ranges of a table.
+enum class Distribution
+{
+  uniform,    // every range equally likely
+  zipfian,    // a few hot ranges (Zipf, s = 0.99) scattered over the table
+  clustered   // keys concentrated around 16 random centers
+};
+
+inline const char *
+to_string (Distribution dist)
+{
+  switch (dist)
+  {
+    case Distribution::uniform:
+      return "uniform";
+    case Distribution::zipfian:
+      return "zipfian";
+    case Distribution::clustered:
+      return "clustered";
+  }
+  return "";
+}
+
+constexpr Distribution all_distributions[] = {
+    Distribution::uniform, Distribution::zipfian, Distribution::clustered};
+
+// Draws indexes in [0, n) following a Distribution. The Zipf sampler is the
+// one from Gray et al., "Quickly Generating Billion-Record Synthetic
+// Databases", which is O(1) per sample after an O(n) setup.
+class IndexGenerator
+{
+public:
+  IndexGenerator (Distribution dist, std::size_t n, std::uint64_t seed) :
+      dist_(dist), n_(n), gen_(seed)
+  {
+    if (dist_ == Distribution::zipfian)
+    {
+      const double theta = 0.99;
+      double zeta_n = 0;
+      for (std::size_t i = 1; i <= n_; ++i)
+      {
+        zeta_n += 1.0 / std::pow(double(i), theta);
+      }
+      const double zeta_2 = 1.0 + 1.0 / std::pow(2.0, theta);
+      alpha_ = 1.0 / (1.0 - theta);
+      zeta_n_ = zeta_n;
+      eta_ = (1.0 - std::pow(2.0 / double(n_), 1.0 - theta))
+             / (1.0 - zeta_2 / zeta_n);
+      theta_ = theta;
+    }
+    else if (dist_ == Distribution::clustered)
+    {
+      std::uniform_int_distribution<std::size_t> center(0, n_ - 1);
+      for (auto &c : centers_)
+      {
+        c = double(center(gen_));
+      }
+    }
+  }
+
+  std::size_t
+  operator() ()
+  {
+    switch (dist_)
+    {
+      case Distribution::uniform:
+        return std::uniform_int_distribution<std::size_t>(0, n_ - 1)(gen_);
+      case Distribution::zipfian:
+      {
+        const double u = std::uniform_real_distribution<double>(0, 1)(gen_);
+        const double uz = u * zeta_n_;
+        std::size_t rank;
+        if (uz < 1.0)
+        {
+          rank = 0;
+        }
+        else if (uz < 1.0 + std::pow(0.5, theta_))
+        {
+          rank = 1;
+        }
+        else
+        {
+          rank = std::size_t(double(n_)
+                             * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+        }
+        // Scatter hot ranks over the table instead of bunching them at 0
+        return std::size_t((rank * 0x9E3779B97F4A7C15ull) % n_);
+      }
+      case Distribution::clustered:
+      {
+        const std::size_t c = gen_() % centers_.size();
+        const double sigma = std::max(1.0, double(n_) / 1000.0);
+        const double x = std::normal_distribution<double>(centers_[c],
+                                                          sigma)(gen_);
+        return std::size_t(std::clamp(x, 0.0, double(n_ - 1)));
+      }
+    }
+    return 0;
+  }
+
+private:
+  Distribution dist_;
+  std::size_t n_;
+  std::mt19937_64 gen_;
+  double alpha_ = 0, zeta_n_ = 0, eta_ = 0, theta_ = 0;
+  std::vector<double> centers_ = std::vector<double>(16);
+};
+
+// One row of output.
+struct Result
+{
+  std::string workload;
+  std::string subject;
+  std::string distribution;
+  std::size_t n;
+  std::size_t ops;
+  double ns_per_op;
+  double instructions_per_op;  // negative if unavailable
+  std::uint64_t checksum;
+};
+
+// Collects results and prints them as an aligned table, CSV or JSON.
+class Reporter
+{
+public:
+  enum class Format
+  {
+    table,
+    csv,
+    json
+  };
+
+  explicit Reporter (Format format) : format_(format) {}
+
+  void
+  add (const Result &result)
+  {
+    if (format_ == Format::table)
+    {
+      if (results_.empty())
+      {
+        std::cout << std::left << std::setw(14) << "workload"
+                  << std::setw(34) << "subject"
+                  << std::setw(11) << "dist"
+                  << std::right << std::setw(11) << "n" << std::endl;
+      }
+      print_row(result);
+    }
+    results_.push_back(result);
+  }
+
+  void
+  finish () const
+  {
+    if (format_ == Format::csv)
+    {
+      std::cout << "workload,subject,distribution,n,ops,ns_per_op,"
+                   "instructions_per_op,checksum\n";
+      for (const auto &r : results_)
+      {
+        std::cout << r.workload << ',' << r.subject << ',' << r.distribution
+                  << ',' << r.n << ',' << r.ops << ',' << r.ns_per_op << ','
+                  << (r.instructions_per_op < 0 ? std::string()
+                                                : std::to_string(r.instructions_per_op))
+                  << ',' << r.checksum << '\n';
+      }
+    }
+    else if (format_ == Format::json)
+    {
+      std::cout << "[\n";
+      for (std::size_t i = 0; i < results_.size(); ++i)
+      {
+        const auto &r = results_[i];
+        std::cout << "  {\"workload\": \"" << r.workload
+                  << "\", \"subject\": \"" << r.subject
+                  << "\", \"distribution\": \"" << r.distribution
+                  << "\", \"n\": " << r.n << ", \"ops\": " << r.ops
+                  << ", \"ns_per_op\": " << r.ns_per_op
+                  << ", \"instructions_per_op\": ";
+        if (r.instructions_per_op < 0)
+        {
+          std::cout << "null";
+        }
+        else
+        {
+          std::cout << r.instructions_per_op;
+        }
+        std::cout << ", \"checksum\": " << r.checksum << "}"
+                  << (i + 1 < results_.size() ? ",\n" : "\n");
+      }
+      std::cout << "]" << std::endl;
+    }
+  }
+
+private:
+  Format format_;
+  std::vector<Result> results_;
+
+  static void
+  print_row (const Result &r)
+  {
+    std::cout << std::left << std::setw(14) << r.workload
+              << std::setw(34) << r.subject
+              << std::setw(11) << r.distribution
+              << std::right << std::setw(11) << r.n
+              << std::setw(11) << std::fixed << std::setprecision(1)
+              << r.ns_per_op << " ns/op";
+    if (r.instructions_per_op >= 0)
+    {
+      std::cout << std::setw(9) << r.instructions_per_op << " instr/op";
+    }
+    std::cout << std::endl;
+  }
+};
+
+// Time a single call of body, which performs ops operations and returns a
+// checksum that keeps the compiler from discarding the work.
+template<typename Body>
+Result
+measure (const std::string &workload, const std::string &subject,
+         Distribution dist, std::size_t n, std::size_t ops, Body body)
+{
+  InstructionCounter counter;
+  const auto start = std::chrono::steady_clock::now();
+  counter.start();
+  const std::uint64_t checksum = std::uint64_t(body());
+  const double instructions = counter.stop();
+  const auto stop = std::chrono::steady_clock::now();
+  const double ns =
+      std::chrono::duration<double, std::nano>(stop - start).count();
+  return {workload, subject, to_string(dist), n, ops, ns / double(ops),
+          instructions < 0 ? -1.0 : instructions / double(ops), checksum};
+}
+
+} /* namespace bench */
+
+#endif //NUMERIC_RANGE_BENCH_COMMON_HPP
@@ -0,0 +1,1055 @@
+#include "bench_common.hpp"
+
+#include "../src/bucketize.hpp"
+#include "../src/canonical_range.hpp"
+#include "../src/concurrent_range_map.hpp"
+#include "../src/eytzinger_index.hpp"
+#include "../src/ip_index.hpp"
+#include "../src/learned_index.hpp"
+#include "../src/parallel_sort.hpp"
+#include "../src/radix_index.hpp"
+#include "../src/range_columns.hpp"
+#include "../src/range_btree.hpp"
+#include "../src/range_file.hpp"
+#include "../src/range_map.hpp"
+#include "../src/range_partition.hpp"
+#include "../src/range_sort.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace numeric_range;
+using bench::Distribution;
+using bench::IndexGenerator;
+using bench::Reporter;
+using bench::measure;
+
+namespace {
+
+struct Options
+{
+  std::vector<std::size_t> sizes{1000, 1000000};
+  std::size_t ops = 1000000;
+  std::string filter;
+  Reporter::Format format = Reporter::Format::table;
+};
+
+// Sorted half-open ranges [2i, 2i + 1), so half of the probes hit a range
+// and half fall into a gap.
+std::vector<NumericRange<double> >
+make_ranges (std::size_t n)
+{
+  std::vector<NumericRange<double> > ranges;
+  ranges.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    ranges.emplace_back(double(2 * i), true, double(2 * i + 1), false);
+  }
+  return ranges;
+}
+
+// Scalar probes near the ranges picked by the distribution.
+std::vector<double>
+make_probes (Distribution dist, std::size_t n, std::size_t count)
+{
+  IndexGenerator index(dist, n, 42);
+  std::mt19937_64 gen(7);
+  std::uniform_real_distribution<double> offset(0, 2);
+  std::vector<double> probes(count);
+  for (auto &x : probes)
+  {
+    x = double(2 * index()) + offset(gen);
+  }
+  return probes;
+}
+
+std::vector<std::size_t>
+make_indexes (Distribution dist, std::size_t n, std::size_t count,
+              std::uint64_t seed)
+{
+  IndexGenerator index(dist, n, seed);
+  std::vector<std::size_t> indexes(count);
+  for (auto &i : indexes)
+  {
+    i = index();
+  }
+  return indexes;
+}
+
+// An address plan of n CIDR blocks: sites of 64 consecutive windows of
+// 2^window_bits addresses at random positions in the top eighth of the
+// space. Every window starts with a block of 1/32 of it up to all of it, like
+// the allocations of a routing table.
+template<typename T>
+std::vector<NumericRange<T> >
+make_address_ranges (std::size_t n, unsigned window_bits)
+{
+  constexpr unsigned key_bits = sizeof(T) * 8;
+  const unsigned site_bits = window_bits + 6;
+  const T top = T(T(1) << (key_bits - 3));
+  const std::uint64_t sites = std::uint64_t(1) << (key_bits - 3 - site_bits);
+  std::mt19937_64 gen(11);
+  std::vector<std::uint64_t> picked;
+  while (picked.size() * 64 < n)
+  {
+    for (std::size_t i = picked.size(); i * 64 < n; ++i)
+    {
+      picked.push_back(gen() % sites);
+    }
+    std::sort(picked.begin(), picked.end());
+    picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+  }
+
+  std::vector<NumericRange<T> > ranges;
+  ranges.reserve(n);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const T lb = T(top + (T(picked[i / 64]) << site_bits)
+                   + (T(i % 64) << window_bits));
+    const T size = T(T(1) << (window_bits - gen() % 6));
+    ranges.emplace_back(lb, true, T(lb + size - 1), true);
+  }
+  return ranges;
+}
+
+// Probes inside the blocks picked by the distribution and in the gaps after
+// them, alternating
+template<typename T>
+std::vector<T>
+make_address_probes (Distribution dist,
+                     const std::vector<NumericRange<T> > &ranges,
+                     std::size_t count)
+{
+  IndexGenerator index(dist, ranges.size(), 42);
+  std::vector<T> probes(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const NumericRange<T> &r = ranges[index()];
+    const T size = T(r.ub - r.lb);
+    probes[i] = i % 2 == 0 ? T(r.lb + (size >> (1 + i % 8)))
+                           : T(r.ub + 1 + (size >> (i % 8)));
+  }
+  return probes;
+}
+
+class Suite
+{
+public:
+  explicit Suite (const Options &options) :
+      options_(options), reporter_(options.format)
+  {}
+
+  void
+  run ()
+  {
+    for (const std::size_t n : options_.sizes)
+    {
+      const auto ranges = make_ranges(n);
+      for (const Distribution dist : bench::all_distributions)
+      {
+        construct(dist, n);
+        compare(dist, ranges);
+        map_insert(dist, ranges);
+        sort(dist, ranges);
+        scan(dist, ranges);
+        lookup(dist, ranges);
+        lookup_int(dist, n);
+        lookup_ip(dist, n);
+        mixed(dist, ranges);
+        bucketize(dist, n);
+      }
+    }
+    reporter_.finish();
+  }
+
+private:
+  const Options &options_;
+  Reporter reporter_;
+  ThreadPool pool_;
+
+  bool
+  enabled (const std::string &workload) const
+  {
+    return options_.filter.empty()
+           || workload.find(options_.filter) != std::string::npos;
+  }
+
+  template<typename Body>
+  void
+  add (const char *workload, const std::string &subject, Distribution dist,
+       std::size_t n, std::size_t ops, Body body)
+  {
+    reporter_.add(measure(workload, subject, dist, n, ops, body));
+  }
+
+  // Constructing NumericRange objects from validated bounds
+  void
+  construct (Distribution dist, std::size_t n)
+  {
+    if (!enabled("construct"))
+    {
+      return;
+    }
+    const auto idx = make_indexes(dist, n, options_.ops, 1);
+    add("construct", "NumericRange(lb, lbi, ub, ubi)", dist, n, idx.size(),
+        [&idx] {
+          double sum = 0;
+          for (const std::size_t i : idx)
+          {
+            const NumericRange<double> r(double(i), true, double(i + 1), false);
+            sum += r.ub - r.lb;
+          }
+          return sum;
+        });
+    add("construct", "NumericRange(scalar)", dist, n, idx.size(), [&idx] {
+      double sum = 0;
+      for (const std::size_t i : idx)
+      {
+        const NumericRange<double> r{double(i)};
+        sum += r.lb;
+      }
+      return sum;
+    });
+  }
+
+  // NumericRangeComparator on scalar/scalar, scalar/range and range/range
+  void
+  compare (Distribution dist, const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("compare"))
+    {
+      return;
+    }
+    const std::size_t n = ranges.size();
+    const auto lhs = make_indexes(dist, n, options_.ops, 2);
+    const auto rhs = make_indexes(dist, n, options_.ops, 3);
+    const NumericRangeComparator<double> comp;
+
+    std::vector<NumericRange<double> > scalars;
+    scalars.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      scalars.emplace_back(double(2 * i) + 0.5);
+    }
+
+    add("compare", "scalar/scalar", dist, n, lhs.size(), [&] {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < lhs.size(); ++i)
+      {
+        count += comp(scalars[lhs[i]], scalars[rhs[i]]);
+      }
+      return count;
+    });
+    add("compare", "scalar/range", dist, n, lhs.size(), [&] {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < lhs.size(); ++i)
+      {
+        count += comp(scalars[lhs[i]], ranges[rhs[i]]);
+      }
+      return count;
+    });
+    add("compare", "range/range", dist, n, lhs.size(), [&] {
+      std::size_t count = 0;
+      for (std::size_t i = 0; i < lhs.size(); ++i)
+      {
+        count += comp(ranges[lhs[i]], ranges[rhs[i]]);
+      }
+      return count;
+    });
+  }
+
+  // std::map inserts as in example/range_map.cpp. Ranges are drawn with
+  // replacement, so repeated draws exercise the "already present" path.
+  void
+  map_insert (Distribution dist,
+              const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("map_insert"))
+    {
+      return;
+    }
+    const auto idx = make_indexes(dist, ranges.size(),
+                                  std::min(options_.ops, ranges.size()), 4);
+    add("map_insert", "std::map", dist, ranges.size(), idx.size(), [&] {
+      std::map<NumericRange<double>, std::size_t,
+               NumericRangeComparator<double> > map;
+      for (const std::size_t i : idx)
+      {
+        map.insert({ranges[i], i});
+      }
+      return map.size();
+    });
+    add("map_insert", "RangeBTree", dist, ranges.size(), idx.size(), [&] {
+      RangeBTree<double, std::size_t> tree;
+      for (const std::size_t i : idx)
+      {
+        tree.insert(ranges[i], i);
+      }
+      return tree.size();
+    });
+
+    // Rebuilding a table from a sorted snapshot
+    std::vector<std::size_t> values(ranges.size());
+    add("map_insert", "RangeMap (sorted_unique)", dist, ranges.size(),
+        ranges.size(), [&] {
+          const RangeMap<double, std::size_t> map(sorted_unique, ranges, values);
+          return map.size();
+        });
+  }
+
+  // std::sort as in example/range_vector.cpp against the library's sorts,
+  // and validation of sorted input
+  void
+  sort (Distribution dist, const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("sort"))
+    {
+      return;
+    }
+    const auto idx = make_indexes(dist, ranges.size(), ranges.size(), 5);
+    std::vector<NumericRange<double> > input;
+    input.reserve(idx.size());
+    for (const std::size_t i : idx)
+    {
+      input.push_back(ranges[i]);
+    }
+
+    add("sort", "std::sort", dist, ranges.size(), input.size(), [&] {
+      auto v = input;
+      std::sort(v.begin(), v.end(), NumericRangeComparator<double>());
+      return std::size_t(v.front().lb + v.back().lb);
+    });
+    add("sort", "sort_ranges", dist, ranges.size(), input.size(), [&] {
+      auto v = input;
+      sort_ranges(v);
+      return std::size_t(v.front().lb + v.back().lb);
+    });
+    const std::string parallel = "parallel_sort_ranges ("
+                                 + std::to_string(pool_.size()) + " threads)";
+    add("sort", parallel, dist, ranges.size(), input.size(), [&] {
+      auto v = input;
+      parallel_sort_ranges(v, pool_);
+      return std::size_t(v.front().lb + v.back().lb);
+    });
+
+    add("sort", "disjoint_sorted_until", dist, ranges.size(), ranges.size(),
+        [&] {
+          return std::size_t(disjoint_sorted_until(ranges.begin(), ranges.end())
+                             - ranges.begin());
+        });
+    add("sort", "parallel_disjoint_sorted_until", dist, ranges.size(),
+        ranges.size(), [&] {
+          return std::size_t(parallel_disjoint_sorted_until(
+              ranges.begin(), ranges.end(), pool_) - ranges.begin());
+        });
+  }
+
+  // Sequential passes over every range, array of structures vs columns
+  void
+  scan (Distribution dist, const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("scan"))
+    {
+      return;
+    }
+    const std::size_t n = ranges.size();
+    const std::size_t passes = std::max<std::size_t>(1, options_.ops / n);
+    add("scan", "std::vector<NumericRange>", dist, n, n * passes, [&] {
+      double sum = 0;
+      for (std::size_t p = 0; p < passes; ++p)
+      {
+        for (const auto &r : ranges)
+        {
+          sum += r.ub_inclusive ? r.ub - r.lb : r.ub - r.lb - 0.5;
+        }
+      }
+      return sum;
+    });
+
+    const RangeColumns<double> columns(ranges);
+    add("scan", "RangeColumns", dist, n, n * passes, [&] {
+      const double *lbs = columns.lbs();
+      const double *ubs = columns.ubs();
+      double sum = 0;
+      for (std::size_t p = 0; p < passes; ++p)
+      {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          sum += columns.ub_inclusive(i) ? ubs[i] - lbs[i]
+                                         : ubs[i] - lbs[i] - 0.5;
+        }
+      }
+      return sum;
+    });
+  }
+
+  // Scalar lookups in every range table implementation
+  void
+  lookup (Distribution dist, const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("lookup"))
+    {
+      return;
+    }
+    const std::size_t n = ranges.size();
+    const auto probes = make_probes(dist, n, options_.ops);
+
+    {
+      std::map<NumericRange<double>, std::size_t,
+               NumericRangeComparator<double> > map;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        map.emplace_hint(map.end(), ranges[i], i);
+      }
+      add("lookup", "std::map", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          auto it = map.find(NumericRange<double>{x});
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+      // The usual way of sharing a table between threads
+      std::mutex mutex;
+      add("lookup", "std::map + std::mutex", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          auto it = map.find(NumericRange<double>{x});
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+      // Heterogeneous lookup through NumericRangeComparator::is_transparent
+      add("lookup", "std::map (raw T)", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          auto it = map.find(x);
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+    }
+
+    {
+      RangeMap<double, std::size_t> map;
+      map.reserve(n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        map.insert(ranges[i], i);
+      }
+      add("lookup", "RangeMap", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          auto it = map.find(x);
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+    }
+
+    {
+      RangeBTree<double, std::size_t> tree;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        tree.insert(ranges[i], i);
+      }
+      add("lookup", "RangeBTree", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          auto it = tree.find(x);
+          sum += it == tree.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+    }
+
+    {
+      std::vector<std::size_t> values(n);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        values[i] = i;
+      }
+      ConcurrentRangeMap<double, std::size_t> map(
+          RangeMap<double, std::size_t>(sorted_unique, ranges, values));
+      const auto reader = map.reader();
+      add("lookup", "ConcurrentRangeMap::Reader", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          sum += reader.find(x).value_or(0);
+        }
+        return sum;
+      });
+
+      const std::string path =
+          (std::filesystem::temp_directory_path() / "numeric_range_bench.bin")
+              .string();
+      write_range_file(path, ranges, values);
+      {
+        const MappedRangeFile<double, std::size_t> file(path);
+        add("lookup", "MappedRangeFile", dist, n, probes.size(), [&] {
+          std::size_t sum = 0;
+          for (const double x : probes)
+          {
+            const std::size_t *value = file.find(x);
+            sum += value == nullptr ? 0 : *value;
+          }
+          return sum;
+        });
+      }
+      std::remove(path.c_str());
+    }
+
+    {
+      const RangeColumns<double> columns(ranges);
+      add("lookup", "RangeColumns", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          const std::size_t pos = columns.find(x);
+          sum += pos == RangeColumns<double>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+    }
+
+    {
+      const ClosedRangeIndex<double> index(ranges);
+      add("lookup", "ClosedRangeIndex", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          const auto pos = index.find(x);
+          sum += pos == ClosedRangeIndex<double>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+      interleaved("ClosedRangeIndex", index, dist, probes);
+    }
+    interpolated<ClosedRangeIndex<double> >("lookup", "ClosedRangeIndex",
+                                            ranges, dist, probes);
+    learned("lookup", ranges, dist, probes);
+
+    {
+      const EytzingerRangeIndex<double> index(ranges);
+      add("lookup", "EytzingerRangeIndex", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const double x : probes)
+        {
+          const auto pos = index.find(x);
+          sum += pos == EytzingerRangeIndex<double>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+      interleaved("EytzingerRangeIndex", index, dist, probes);
+
+      const std::pair<const char *, detail::SimdLevel> levels[] = {
+          {"lookup_batch (scalar)", detail::SimdLevel::scalar},
+          {"lookup_batch (avx2)", detail::SimdLevel::avx2},
+          {"lookup_batch (avx512)", detail::SimdLevel::avx512}};
+      std::vector<std::uint32_t> out(probes.size());
+      for (const auto &level : levels)
+      {
+        detail::set_simd_level(level.second);
+        if (detail::simd_level() != level.second)
+        {
+          continue;
+        }
+        add("lookup", level.first, dist, n, probes.size(), [&] {
+          index.lookup_batch(probes.data(), probes.size(), out.data());
+          std::size_t sum = 0;
+          for (const std::uint32_t pos : out)
+          {
+            sum += pos == EytzingerRangeIndex<double>::npos ? 0 : pos;
+          }
+          return sum;
+        });
+      }
+      detail::set_simd_level(detail::detect_simd_level());
+    }
+  }
+
+  // A sorted range index searched with each interpolating strategy
+  template<typename Index, typename T>
+  void
+  interpolated (const char *workload, const std::string &name,
+                const std::vector<NumericRange<T> > &ranges, Distribution dist,
+                const std::vector<T> &probes)
+  {
+    const std::pair<const char *, SearchStrategy> strategies[] = {
+        {"interpolation", SearchStrategy::interpolation},
+        {"interpolation-sequential", SearchStrategy::interpolation_sequential}};
+    for (const auto &strategy : strategies)
+    {
+      const Index index(ranges, strategy.second);
+      add(workload, name + " (" + strategy.first + ")", dist, ranges.size(),
+          probes.size(), [&] {
+            std::size_t sum = 0;
+            for (const T x : probes)
+            {
+              const auto pos = index.find(x);
+              sum += pos == Index::npos ? 0 : pos;
+            }
+            return sum;
+          });
+    }
+  }
+
+  // LearnedRangeIndex with a tight and a loose error bound. The model size
+  // goes into the subject since it depends on how regular the table is.
+  template<typename T>
+  void
+  learned (const char *workload, const std::vector<NumericRange<T> > &ranges,
+           Distribution dist, const std::vector<T> &probes)
+  {
+    for (const std::size_t max_error : {8, 64})
+    {
+      const LearnedRangeIndex<T> index(ranges, max_error);
+      const std::string subject =
+          "LearnedRangeIndex (e=" + std::to_string(max_error) + ", "
+          + std::to_string(index.segment_count()) + " seg, "
+          + std::to_string(index.model_size()) + " B)";
+      add(workload, subject, dist, ranges.size(), probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const T x : probes)
+        {
+          const auto pos = index.find(x);
+          sum += pos == LearnedRangeIndex<T>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+    }
+  }
+
+  // RadixRangeIndex, one key at a time and batched. The radix bits and the
+  // sizes of the top-level table and of the whole index go into the subject.
+  template<typename T>
+  void
+  radix (const char *workload, const std::vector<NumericRange<T> > &ranges,
+         Distribution dist, const std::vector<T> &probes)
+  {
+    const RadixRangeIndex<T> index(ranges);
+    const std::string subject =
+        "RadixRangeIndex (k=" + std::to_string(index.radix_bits()) + ", "
+        + std::to_string(index.table_size() / 1024) + "/"
+        + std::to_string(index.memory_usage() / 1024) + " KiB)";
+    add(workload, subject, dist, ranges.size(), probes.size(), [&] {
+      std::size_t sum = 0;
+      for (const T x : probes)
+      {
+        const auto pos = index.find(x);
+        sum += pos == RadixRangeIndex<T>::npos ? 0 : pos;
+      }
+      return sum;
+    });
+
+    std::vector<std::uint32_t> out(probes.size());
+    add(workload, "RadixRangeIndex batch", dist, ranges.size(), probes.size(),
+        [&] {
+          index.lookup_batch(probes.data(), probes.size(), out.data());
+          std::size_t sum = 0;
+          for (const std::uint32_t pos : out)
+          {
+            sum += pos == RadixRangeIndex<T>::npos ? 0 : pos;
+          }
+          return sum;
+        });
+  }
+
+  // Batched lookups with several group sizes
+  template<typename Index>
+  void
+  interleaved (const std::string &name, const Index &index, Distribution dist,
+               const std::vector<double> &probes)
+  {
+    std::vector<std::uint32_t> out(probes.size());
+    for (const std::size_t group : {4, 16, 32})
+    {
+      add("lookup", name + " interleaved (G=" + std::to_string(group) + ")",
+          dist, index.size(), probes.size(), [&] {
+            index.lookup_interleaved(probes.data(), probes.size(), out.data(),
+                                     group);
+            std::size_t sum = 0;
+            for (const std::uint32_t pos : out)
+            {
+              sum += pos == Index::npos ? 0 : pos;
+            }
+            return sum;
+          });
+    }
+  }
+
+  // A table under a steady stream of updates: half of the operations are
+  // lookups, a quarter insert a range and a quarter erase one. Half of the
+  // ranges are present at the start.
+  void
+  mixed (Distribution dist, const std::vector<NumericRange<double> > &ranges)
+  {
+    if (!enabled("mixed"))
+    {
+      return;
+    }
+    const std::size_t n = ranges.size();
+    const auto idx = make_indexes(dist, n, options_.ops, 5);
+    const auto probes = make_probes(dist, n, options_.ops);
+    const auto run = [&] (auto &table) {
+      std::size_t sum = 0;
+      for (std::size_t i = 0; i < idx.size(); ++i)
+      {
+        switch (i % 4)
+        {
+          case 0:
+            sum += table.insert({ranges[idx[i]], idx[i]}).second;
+            break;
+          case 1:
+            sum += table.erase(ranges[idx[i]]);
+            break;
+          default:
+          {
+            auto it = table.find(probes[i]);
+            sum += it == table.end() ? 0 : it->second;
+          }
+        }
+      }
+      return sum;
+    };
+
+    std::map<NumericRange<double>, std::size_t,
+             NumericRangeComparator<double> > map;
+    RangeBTree<double, std::size_t> tree;
+    RangeMap<double, std::size_t> flat;
+    for (std::size_t i = 0; i < n; i += 2)
+    {
+      map.emplace_hint(map.end(), ranges[i], i);
+      tree.insert(ranges[i], i);
+      flat.insert(ranges[i], i);
+    }
+    add("mixed", "std::map", dist, n, idx.size(), [&] { return run(map); });
+    add("mixed", "RangeBTree", dist, n, idx.size(), [&] { return run(tree); });
+    // Inserts and erases shift half the table on average
+    if (n <= 100000)
+    {
+      add("mixed", "RangeMap", dist, n, idx.size(), [&] { return run(flat); });
+    }
+  }
+
+  // Scalar lookups in integral range tables with mixed bound kinds
+  void
+  lookup_int (Distribution dist, std::size_t n)
+  {
+    if (!enabled("lookup_int"))
+    {
+      return;
+    }
+    // Closed ranges [4i, 4i + 2] and open ranges (4i, 4i + 3), alternating
+    std::vector<NumericRange<std::int64_t> > ranges;
+    ranges.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      const auto lb = std::int64_t(4 * i);
+      ranges.emplace_back(lb, i % 2 == 0, lb + 2 + std::int64_t(i % 2),
+                          i % 2 == 0);
+    }
+    const auto indexes = make_indexes(dist, n, options_.ops, 42);
+    std::vector<std::int64_t> probes(indexes.size());
+    for (std::size_t i = 0; i < probes.size(); ++i)
+    {
+      probes[i] = std::int64_t(4 * indexes[i] + i % 4);
+    }
+
+    {
+      std::map<NumericRange<std::int64_t>, std::size_t,
+               NumericRangeComparator<std::int64_t> > map;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        map.emplace_hint(map.end(), ranges[i], i);
+      }
+      add("lookup_int", "std::map (raw T)", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const std::int64_t x : probes)
+        {
+          auto it = map.find(x);
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+    }
+
+    {
+      const EytzingerRangeIndex<std::int64_t> index(ranges);
+      add("lookup_int", "EytzingerRangeIndex", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const std::int64_t x : probes)
+        {
+          const auto pos = index.find(x);
+          sum += pos == EytzingerRangeIndex<std::int64_t>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+    }
+
+    {
+      const HalfOpenRangeIndex<std::int64_t> index(ranges);
+      add("lookup_int", "HalfOpenRangeIndex", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const std::int64_t x : probes)
+        {
+          const auto pos = index.find(x);
+          sum += pos == HalfOpenRangeIndex<std::int64_t>::npos ? 0 : pos;
+        }
+        return sum;
+      });
+    }
+    interpolated<HalfOpenRangeIndex<std::int64_t> >(
+        "lookup_int", "HalfOpenRangeIndex", ranges, dist, probes);
+    learned("lookup_int", ranges, dist, probes);
+    radix("lookup_int", ranges, dist, probes);
+  }
+
+  // Address lookups in IPv4 and IPv6 block tables, mapping an address to
+  // the metadata of its block as in example/range_map.cpp
+  void
+  lookup_ip (Distribution dist, std::size_t n)
+  {
+    if (!enabled("lookup_ip"))
+    {
+      return;
+    }
+    // /26 to /31 blocks in windows of 64 addresses
+    const auto v4 = make_address_ranges<std::uint32_t>(n, 6);
+    const auto v4_probes = make_address_probes(dist, v4, options_.ops);
+    ip_tables("IPv4", v4, dist, v4_probes);
+    radix("lookup_ip", v4, dist, v4_probes);
+#ifdef NUMERIC_RANGE_HAS_INT128
+    // /48 to /53 blocks
+    const auto v6 = make_address_ranges<uint128_t>(n, 80);
+    const auto v6_probes = make_address_probes(dist, v6, options_.ops);
+    ip_tables("IPv6", v6, dist, v6_probes);
+#endif
+  }
+
+  // std::map and IpRangeIndex over one address family, one key at a time
+  // and interleaved. The trie depth, node count and size go into the subject,
+  // next to the time to build it.
+  template<typename T>
+  void
+  ip_tables (const std::string &family,
+             const std::vector<NumericRange<T> > &ranges, Distribution dist,
+             const std::vector<T> &probes)
+  {
+    const std::size_t n = ranges.size();
+    {
+      std::map<NumericRange<T>, std::size_t, NumericRangeComparator<T> > map;
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        map.emplace_hint(map.end(), ranges[i], i);
+      }
+      add("lookup_ip", family + " std::map", dist, n, probes.size(), [&] {
+        std::size_t sum = 0;
+        for (const T x : probes)
+        {
+          auto it = map.find(x);
+          sum += it == map.end() ? 0 : it->second;
+        }
+        return sum;
+      });
+    }
+
+    add("lookup_ip", family + " IpRangeIndex build", dist, n, n, [&] {
+      const IpRangeIndex<T> index(ranges);
+      return index.node_count();
+    });
+    const IpRangeIndex<T> index(ranges);
+    const std::string subject =
+        family + " IpRangeIndex (d=" + std::to_string(index.depth()) + ", "
+        + std::to_string(index.node_count()) + " nodes, "
+        + std::to_string(index.trie_size() / 1024) + "/"
+        + std::to_string(index.memory_usage() / 1024) + " KiB)";
+    add("lookup_ip", subject, dist, n, probes.size(), [&] {
+      std::size_t sum = 0;
+      for (const T x : probes)
+      {
+        const auto pos = index.find(x);
+        sum += pos == IpRangeIndex<T>::npos ? 0 : pos;
+      }
+      return sum;
+    });
+
+    std::vector<std::uint32_t> out(probes.size());
+    add("lookup_ip", family + " IpRangeIndex interleaved", dist, n,
+        probes.size(), [&] {
+          index.lookup_interleaved(probes.data(), probes.size(), out.data());
+          std::size_t sum = 0;
+          for (const std::uint32_t pos : out)
+          {
+            sum += pos == IpRangeIndex<T>::npos ? 0 : pos;
+          }
+          return sum;
+        });
+  }
+
+  // Classifying a column of values by n buckets that tile [0, n)
+  void
+  bucketize (Distribution dist, std::size_t n)
+  {
+    if (!enabled("bucketize"))
+    {
+      return;
+    }
+    const auto indexes = make_indexes(dist, n, options_.ops, 42);
+    std::vector<float> floats(indexes.size());
+    std::vector<std::int32_t> ints(indexes.size());
+    for (std::size_t i = 0; i < indexes.size(); ++i)
+    {
+      floats[i] = float(indexes[i]) + float(i % 4) * 0.25f;
+      ints[i] = std::int32_t(indexes[i]);
+    }
+    bucketize_column("float", dist, n, floats);
+    bucketize_column("int32", dist, n, ints);
+  }
+
+  template<typename T>
+  void
+  bucketize_column (const std::string &type, Distribution dist, std::size_t n,
+                    const std::vector<T> &column)
+  {
+    std::vector<T> bounds(n + 1);
+    for (std::size_t i = 0; i <= n; ++i)
+    {
+      bounds[i] = T(i);
+    }
+    const RangePartition<T, char> partition(bounds, std::vector<char>(n),
+                                            BoundarySide::right);
+    std::vector<std::uint32_t> out(column.size());
+    const auto checksum = [&out] {
+      std::size_t sum = 0;
+      for (const std::uint32_t bucket : out)
+      {
+        sum += bucket;
+      }
+      return sum;
+    };
+
+    add("bucketize", type + " std::upper_bound", dist, n, column.size(), [&] {
+      for (std::size_t i = 0; i < column.size(); ++i)
+      {
+        const auto it = std::upper_bound(bounds.begin(), bounds.end(),
+                                         column[i]);
+        const auto pos = std::size_t(it - bounds.begin());
+        out[i] = pos == 0 || pos > n ? bucketize_miss : std::uint32_t(pos - 1);
+      }
+      return checksum();
+    });
+
+    const Bucketizer<T> search(partition, BucketizeStrategy::search);
+    detail::set_simd_level(detail::SimdLevel::scalar);
+    add("bucketize", type + " search (scalar)", dist, n, column.size(), [&] {
+      search.bucketize(column.data(), column.size(), out.data());
+      return checksum();
+    });
+    detail::set_simd_level(detail::detect_simd_level());
+    add("bucketize", type + " search", dist, n, column.size(), [&] {
+      search.bucketize(column.data(), column.size(), out.data());
+      return checksum();
+    });
+    if (n <= 1024)
+    {
+      const Bucketizer<T> linear(partition, BucketizeStrategy::linear);
+      add("bucketize", type + " linear", dist, n, column.size(), [&] {
+        linear.bucketize(column.data(), column.size(), out.data());
+        return checksum();
+      });
+    }
+  }
+}; /* class Suite */
+
+std::vector<std::size_t>
+parse_sizes (const char *list)
+{
+  std::vector<std::size_t> sizes;
+  const std::string s(list);
+  std::size_t start = 0;
+  while (start < s.size())
+  {
+    std::size_t end = s.find(',', start);
+    end = end == std::string::npos ? s.size() : end;
+    sizes.push_back(std::strtoull(s.substr(start, end - start).c_str(),
+                                  nullptr, 10));
+    start = end + 1;
+  }
+  return sizes;
+}
+
+void
+usage (const char *argv0)
+{
+  std::cerr << "Usage: " << argv0 << " [options]\n"
+            << "  --sizes=N[,N...]         table sizes (default 1000,1000000)\n"
+            << "  --ops=N                  operations per measurement (default 1000000)\n"
+            << "  --filter=WORKLOAD        only run workloads containing this string\n"
+            << "                           (construct, compare, map_insert, sort, scan,\n"
+            << "                           lookup, lookup_int, lookup_ip, mixed,\n"
+            << "                           bucketize)\n"
+            << "  --format=table|csv|json  output format (default table)\n";
+}
+
+} /* namespace */
+
+// Benchmarks the library across workloads, key distributions and table
+// sizes. Large tables, e.g. --sizes=100000000, need several gigabytes of
+// memory for the std::map baseline alone.
+int main (int argc, char **argv)
+{
+  Options options;
+  for (int i = 1; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    if (std::strncmp(arg, "--sizes=", 8) == 0)
+    {
+      options.sizes = parse_sizes(arg + 8);
+    }
+    else if (std::strncmp(arg, "--ops=", 6) == 0)
+    {
+      options.ops = std::strtoull(arg + 6, nullptr, 10);
+    }
+    else if (std::strncmp(arg, "--filter=", 9) == 0)
+    {
+      options.filter = arg + 9;
+    }
+    else if (std::strcmp(arg, "--format=csv") == 0)
+    {
+      options.format = Reporter::Format::csv;
+    }
+    else if (std::strcmp(arg, "--format=json") == 0)
+    {
+      options.format = Reporter::Format::json;
+    }
+    else if (std::strcmp(arg, "--format=table") == 0)
+    {
+      options.format = Reporter::Format::table;
+    }
+    else
+    {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  Suite(options).run();
+  return 0;
+}
@@ -34,9 +34,15 @@ int main ()
   std::cout << range_based_map[NumericRange{2}] << std::endl;
   std::cout << range_based_map[NumericRange{6}] << std::endl;
 
-  // Note that the range (1, 2) inserted above uses *exclusive* bounds,
-  // so a value should not be found for 2!
-  auto nonexistent = range_based_map.find(NumericRange{4});
+  // The comparator also supports lookups with a raw value, which avoids
+  // constructing a NumericRange for every lookup
+  auto existent = range_based_map.find(2);
+  if (existent != range_based_map.end())
+    std::cout << existent->second << std::endl;
+
+  // Note that no range inserted above covers 4, so a value should not be
+  // found for it!
+  auto nonexistent = range_based_map.find(4);
   if (nonexistent != range_based_map.end())
     std::cout << nonexistent->second << std::endl;
   else
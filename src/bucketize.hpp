@@ -0,0 +1,282 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Assigning a bucket to every element of a column of values, the equivalent
+ * of numpy's digitize, for a RangePartition or sorted ranges.
+ */
+
+#ifndef NUMERIC_RANGE_BUCKETIZE_HPP
+#define NUMERIC_RANGE_BUCKETIZE_HPP
+
+#include "bucketize_simd.hpp"
+#include "cache_utils.hpp"
+#include "interpolation_search.hpp"
+#include "numeric_range.hpp"
+#include "range_partition.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/// Written by bucketize for values that lie in no bucket.
+constexpr std::uint32_t bucketize_miss =
+    std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * How a Bucketizer searches for the bucket of a value.
+ */
+enum class BucketizeStrategy
+{
+  automatic,  ///< linear for small tables, search otherwise
+  linear,     ///< Compare every value with every bound
+  search      ///< Branch-free binary search
+};
+
+namespace detail {
+
+// Tables with at most this many cuts are scanned linearly by default.
+constexpr std::size_t bucketize_linear_cuts = 32;
+
+/**
+ * The smallest value of T greater than x.
+ * @param x
+ * @param out
+ * @return false if x is the largest value of T
+ */
+template<typename T>
+bool
+next_value (const T x, T &out)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    out = std::nextafter(x, std::numeric_limits<T>::infinity());
+    return x < out;
+  }
+  else
+  {
+    out = T(x + 1);
+    return x != std::numeric_limits<T>::max();
+  }
+}
+
+} /* namespace detail */
+
+/**
+ * A Bucketizer classifies arrays of values by a fixed set of buckets, given
+ * as a RangePartition or as sorted, non-overlapping ranges. It reduces the
+ * buckets to sorted cuts: values at which the bucket of a growing x
+ * changes. The bucket of x then only depends on how many cuts are <= x, so
+ * inclusive and exclusive bounds cost nothing at lookup time.
+ * On x86-64 CPUs with AVX2 or AVX-512 and for 32/64-bit signed integer or
+ * floating point T, several values are processed per instruction. Small
+ * tables compare each value with every cut, larger ones use a branch-free
+ * binary search in every lane.
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+class Bucketizer
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "Bucketizer requires an arithmetic type");
+
+public:
+  /**
+   * Bucket i of the result is bucket i of partition.
+   * @param partition
+   * @param strategy
+   * @throws length_error If there are bucketize_miss or more buckets
+   */
+  template<typename V>
+  explicit Bucketizer (const RangePartition<T, V> &partition,
+                       BucketizeStrategy strategy = BucketizeStrategy::automatic)
+  {
+    check_size(partition.size());
+    const T *bounds = partition.boundaries();
+    for (std::size_t i = 0; i < partition.boundary_count(); ++i)
+    {
+      // A boundary on the left side still belongs to the previous bucket
+      if (partition.side(i) == BoundarySide::right)
+      {
+        cuts_.push_back(bounds[i]);
+      }
+      else
+      {
+        add_cut_after(bounds[i]);
+      }
+    }
+    // k cuts <= x means bucket k - 1
+    slots_.assign(cuts_.size() + 1, bucketize_miss);
+    for (std::size_t k = 1; k < slots_.size() && k <= partition.size(); ++k)
+    {
+      slots_[k] = std::uint32_t(k - 1);
+    }
+    set_strategy(strategy);
+  }
+
+  /**
+   * Bucket i of the result is sorted[i].
+   * @param sorted Ranges sorted by NumericRangeComparator
+   * @param strategy
+   * @throws runtime_error If the ranges overlap or are not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If there are bucketize_miss or more ranges
+   */
+  explicit Bucketizer (const std::vector<NumericRange<T> > &sorted,
+                       BucketizeStrategy strategy = BucketizeStrategy::automatic)
+  {
+    check_size(sorted.size());
+    detail::check_disjoint_sorted(sorted.begin(), sorted.end());
+    for (const NumericRange<T> &range : sorted)
+    {
+      cuts_.push_back(detail::closed_lb(range));
+      if (range.ub_inclusive)
+      {
+        add_cut_after(range.ub);
+      }
+      else
+      {
+        cuts_.push_back(range.ub);
+      }
+    }
+    // 2i + 1 cuts <= x means range i, an even number means a gap
+    slots_.assign(cuts_.size() + 1, bucketize_miss);
+    for (std::size_t k = 1; k < slots_.size(); k += 2)
+    {
+      slots_[k] = std::uint32_t(k / 2);
+    }
+    set_strategy(strategy);
+  }
+
+  /**
+   * @param x
+   * @return Bucket containing x, or bucketize_miss
+   */
+  std::uint32_t
+  find (const T x) const
+  {
+    return slots_[count_le(x)];
+  }
+
+  /**
+   * Set out[i] to the bucket containing in[i], or to bucketize_miss.
+   * @param in Array of n values
+   * @param n
+   * @param out Array of n buckets
+   */
+  void
+  bucketize (const T *in, std::size_t n, std::uint32_t *out) const
+  {
+    std::size_t done = 0;
+    if (!cuts_.empty())
+    {
+      const detail::BucketizeView<T> view{cuts_.data(), cuts_.size(),
+                                          slots_.data()};
+      done = detail::bucketize_simd(view, in, n, out, linear_);
+    }
+    for (; done < n; ++done)
+    {
+      out[done] = find(in[done]);
+    }
+  }
+
+  /**
+   * @return Number of cuts the buckets were reduced to
+   */
+  std::size_t cut_count () const { return cuts_.size(); }
+
+private:
+  detail::aligned_vector<T> cuts_;
+  std::vector<std::uint32_t> slots_;
+  bool linear_ = false;
+
+  static void
+  check_size (std::size_t buckets)
+  {
+    if (buckets >= bucketize_miss)
+    {
+      NUMERIC_RANGE_THROW(std::length_error("Too many buckets for Bucketizer"));
+    }
+  }
+
+  /**
+   * Add a cut for the values greater than x. There is none above the
+   * largest value of T, and such a cut could only be the last one.
+   */
+  void
+  add_cut_after (const T x)
+  {
+    T next;
+    if (detail::next_value(x, next))
+    {
+      cuts_.push_back(next);
+    }
+  }
+
+  void
+  set_strategy (BucketizeStrategy strategy)
+  {
+    linear_ = strategy == BucketizeStrategy::linear
+              || (strategy == BucketizeStrategy::automatic
+                  && cuts_.size() <= detail::bucketize_linear_cuts);
+  }
+
+  std::size_t
+  count_le (const T x) const
+  {
+    const std::size_t size = cuts_.size();
+    if (size == 0)
+    {
+      return 0;
+    }
+    const std::size_t base = detail::last_le(cuts_.data(), 0, size, x);
+    return base + (cuts_[base] <= x);
+  }
+}; /* class Bucketizer */
+
+/**
+ * Set out[i] to the bucket of partition containing in[i], or to
+ * bucketize_miss. Build a Bucketizer instead to classify several arrays by
+ * the same partition.
+ * @param in Array of n values
+ * @param n
+ * @param partition
+ * @param out Array of n buckets
+ */
+template<typename T, typename V>
+void
+bucketize (const T *in, std::size_t n, const RangePartition<T, V> &partition,
+           std::uint32_t *out)
+{
+  Bucketizer<T>(partition).bucketize(in, n, out);
+}
+
+/**
+ * Set out[i] to the position of the range in sorted containing in[i], or to
+ * bucketize_miss. Build a Bucketizer instead to classify several arrays by
+ * the same ranges.
+ * @param in Array of n values
+ * @param n
+ * @param sorted Ranges sorted by NumericRangeComparator
+ * @param out Array of n positions
+ * @throws runtime_error If the ranges overlap or are not strictly sorted
+ */
+template<typename T>
+void
+bucketize (const T *in, std::size_t n,
+           const std::vector<NumericRange<T> > &sorted, std::uint32_t *out)
+{
+  Bucketizer<T>(sorted).bucketize(in, n, out);
+}
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_BUCKETIZE_HPP
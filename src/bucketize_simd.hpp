@@ -0,0 +1,320 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * AVX2 and AVX-512 kernels for Bucketizer. Each lane counts the cuts that
+ * are <= its value, either by comparing against every cut in turn (linear)
+ * or with a branch-free binary search whose step sizes are the same in all
+ * lanes (search), and then maps the count to a bucket through a small table.
+ */
+
+#ifndef NUMERIC_RANGE_BUCKETIZE_SIMD_HPP
+#define NUMERIC_RANGE_BUCKETIZE_SIMD_HPP
+
+#include "simd_dispatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace numeric_range {
+
+namespace detail {
+
+/**
+ * Read-only view of the arrays of a Bucketizer. slots has count + 1
+ * entries, one per possible number of cuts <= x. count must not be 0.
+ */
+template<typename T>
+struct BucketizeView
+{
+  const T *cuts;
+  std::size_t count;
+  const std::uint32_t *slots;
+};
+
+#ifdef NUMERIC_RANGE_X86_SIMD
+
+template<typename T>
+__attribute__((target("avx512f"))) inline __mmask16
+avx512_cut_le_32 (__m512i c, __m512i x)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return _mm512_cmp_ps_mask(_mm512_castsi512_ps(c), _mm512_castsi512_ps(x),
+                              _CMP_LE_OQ);
+  }
+  else
+  {
+    return _mm512_cmple_epi32_mask(c, x);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline __mmask8
+avx512_cut_le_64 (__m512i c, __m512i x)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return _mm512_cmp_pd_mask(_mm512_castsi512_pd(c), _mm512_castsi512_pd(x),
+                              _CMP_LE_OQ);
+  }
+  else
+  {
+    return _mm512_cmple_epi64_mask(c, x);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline __m256i
+avx2_cut_le_32 (__m256i c, __m256i x)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return _mm256_castps_si256(_mm256_cmp_ps(
+        _mm256_castsi256_ps(c), _mm256_castsi256_ps(x), _CMP_LE_OQ));
+  }
+  else
+  {
+    return _mm256_xor_si256(_mm256_cmpgt_epi32(c, x), _mm256_set1_epi32(-1));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline __m256i
+avx2_cut_le_64 (__m256i c, __m256i x)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return _mm256_castpd_si256(_mm256_cmp_pd(
+        _mm256_castsi256_pd(c), _mm256_castsi256_pd(x), _CMP_LE_OQ));
+  }
+  else
+  {
+    return _mm256_xor_si256(_mm256_cmpgt_epi64(c, x), _mm256_set1_epi64x(-1));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+bucketize_avx512_32 (const BucketizeView<T> &v, const T *in, std::size_t n,
+                     std::uint32_t *out, bool linear)
+{
+  const __m512i one = _mm512_set1_epi32(1);
+  // Masked gathers with an explicit source, since the unmasked forms leave
+  // their destination formally uninitialized
+  const __m512i zero = _mm512_setzero_si512();
+  const int *cuts = reinterpret_cast<const int *>(v.cuts);
+  for (std::size_t i = 0; i + 16 <= n; i += 16)
+  {
+    const __m512i x = _mm512_loadu_si512(in + i);
+    __m512i count = _mm512_setzero_si512();
+    if (linear)
+    {
+      for (std::size_t j = 0; j < v.count; ++j)
+      {
+        const __mmask16 le =
+            avx512_cut_le_32<T>(_mm512_set1_epi32(cuts[j]), x);
+        count = _mm512_mask_add_epi32(count, le, count, one);
+      }
+    }
+    else
+    {
+      for (std::size_t m = v.count; m > 1; m -= m / 2)
+      {
+        const __m512i idx = _mm512_add_epi32(count,
+                                             _mm512_set1_epi32(int(m / 2)));
+        const __m512i c = _mm512_mask_i32gather_epi32(zero, 0xFFFF, idx, cuts,
+                                                      4);
+        count = _mm512_mask_mov_epi32(count, avx512_cut_le_32<T>(c, x), idx);
+      }
+      const __m512i c = _mm512_mask_i32gather_epi32(zero, 0xFFFF, count, cuts,
+                                                    4);
+      count = _mm512_mask_add_epi32(count, avx512_cut_le_32<T>(c, x), count,
+                                     one);
+    }
+    _mm512_storeu_si512(out + i, _mm512_mask_i32gather_epi32(
+                                     zero, 0xFFFF, count, v.slots, 4));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+bucketize_avx512_64 (const BucketizeView<T> &v, const T *in, std::size_t n,
+                     std::uint32_t *out, bool linear)
+{
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i zero = _mm512_setzero_si512();
+  const auto *cuts = reinterpret_cast<const long long *>(v.cuts);
+  for (std::size_t i = 0; i + 8 <= n; i += 8)
+  {
+    const __m512i x = _mm512_loadu_si512(in + i);
+    __m512i count = _mm512_setzero_si512();
+    if (linear)
+    {
+      for (std::size_t j = 0; j < v.count; ++j)
+      {
+        const __mmask8 le =
+            avx512_cut_le_64<T>(_mm512_set1_epi64(cuts[j]), x);
+        count = _mm512_mask_add_epi64(count, le, count, one);
+      }
+    }
+    else
+    {
+      for (std::size_t m = v.count; m > 1; m -= m / 2)
+      {
+        const __m512i idx = _mm512_add_epi64(
+            count, _mm512_set1_epi64((long long) (m / 2)));
+        const __m512i c = _mm512_mask_i64gather_epi64(zero, 0xFF, idx, cuts,
+                                                      8);
+        count = _mm512_mask_mov_epi64(count, avx512_cut_le_64<T>(c, x), idx);
+      }
+      const __m512i c = _mm512_mask_i64gather_epi64(zero, 0xFF, count, cuts,
+                                                    8);
+      count = _mm512_mask_add_epi64(count, avx512_cut_le_64<T>(c, x), count,
+                                     one);
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm512_mask_i64gather_epi32(_mm256_setzero_si256(),
+                                                    0xFF, count, v.slots, 4));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline void
+bucketize_avx2_32 (const BucketizeView<T> &v, const T *in, std::size_t n,
+                   std::uint32_t *out, bool linear)
+{
+  const int *cuts = reinterpret_cast<const int *>(v.cuts);
+  const int *slots = reinterpret_cast<const int *>(v.slots);
+  for (std::size_t i = 0; i + 8 <= n; i += 8)
+  {
+    const __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(in + i));
+    __m256i count = _mm256_setzero_si256();
+    if (linear)
+    {
+      for (std::size_t j = 0; j < v.count; ++j)
+      {
+        // le is all ones (-1) when true
+        count = _mm256_sub_epi32(
+            count, avx2_cut_le_32<T>(_mm256_set1_epi32(cuts[j]), x));
+      }
+    }
+    else
+    {
+      for (std::size_t m = v.count; m > 1; m -= m / 2)
+      {
+        const __m256i idx = _mm256_add_epi32(count,
+                                             _mm256_set1_epi32(int(m / 2)));
+        const __m256i c = _mm256_i32gather_epi32(cuts, idx, 4);
+        count = _mm256_blendv_epi8(count, idx, avx2_cut_le_32<T>(c, x));
+      }
+      const __m256i c = _mm256_i32gather_epi32(cuts, count, 4);
+      count = _mm256_sub_epi32(count, avx2_cut_le_32<T>(c, x));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        _mm256_i32gather_epi32(slots, count, 4));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline void
+bucketize_avx2_64 (const BucketizeView<T> &v, const T *in, std::size_t n,
+                   std::uint32_t *out, bool linear)
+{
+  const auto *cuts = reinterpret_cast<const long long *>(v.cuts);
+  const int *slots = reinterpret_cast<const int *>(v.slots);
+  for (std::size_t i = 0; i + 4 <= n; i += 4)
+  {
+    const __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(in + i));
+    __m256i count = _mm256_setzero_si256();
+    if (linear)
+    {
+      for (std::size_t j = 0; j < v.count; ++j)
+      {
+        count = _mm256_sub_epi64(
+            count, avx2_cut_le_64<T>(_mm256_set1_epi64x(cuts[j]), x));
+      }
+    }
+    else
+    {
+      for (std::size_t m = v.count; m > 1; m -= m / 2)
+      {
+        const __m256i idx = _mm256_add_epi64(
+            count, _mm256_set1_epi64x((long long) (m / 2)));
+        const __m256i c = _mm256_i64gather_epi64(cuts, idx, 8);
+        count = _mm256_blendv_epi8(count, idx, avx2_cut_le_64<T>(c, x));
+      }
+      const __m256i c = _mm256_i64gather_epi64(cuts, count, 8);
+      count = _mm256_sub_epi64(count, avx2_cut_le_64<T>(c, x));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                     _mm256_i64gather_epi32(slots, count, 4));
+  }
+}
+
+#endif /* NUMERIC_RANGE_X86_SIMD */
+
+/**
+ * Run the widest available kernel over as many values as it handles.
+ * @return Number of leading values processed; the caller handles the rest
+ */
+template<typename T>
+std::size_t
+bucketize_simd (const BucketizeView<T> &v, const T *in, std::size_t n,
+                std::uint32_t *out, bool linear)
+{
+#ifdef NUMERIC_RANGE_X86_SIMD
+  if constexpr (simd_key<T>::value)
+  {
+    // 32-bit lanes index the cuts with signed 32-bit integers
+    if (sizeof(T) == 4 && v.count >= (std::size_t(1) << 31))
+    {
+      return 0;
+    }
+    const SimdLevel level = simd_level();
+    if (level == SimdLevel::avx512)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        bucketize_avx512_32(v, in, n, out, linear);
+        return n - n % 16;
+      }
+      else
+      {
+        bucketize_avx512_64(v, in, n, out, linear);
+        return n - n % 8;
+      }
+    }
+    if (level == SimdLevel::avx2)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        bucketize_avx2_32(v, in, n, out, linear);
+        return n - n % 8;
+      }
+      else
+      {
+        bucketize_avx2_64(v, in, n, out, linear);
+        return n - n % 4;
+      }
+    }
+  }
+#endif
+  (void) v;
+  (void) in;
+  (void) n;
+  (void) out;
+  (void) linear;
+  return 0;
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_BUCKETIZE_SIMD_HPP
@@ -0,0 +1,98 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Cache-related helpers shared by the index structures: an allocator that
+ * aligns storage to a cache line and a portable software prefetch.
+ */
+
+#ifndef NUMERIC_RANGE_CACHE_UTILS_HPP
+#define NUMERIC_RANGE_CACHE_UTILS_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace numeric_range {
+
+namespace detail {
+
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * Standard-conforming allocator that aligns every allocation to Alignment
+ * bytes using the C++17 aligned operator new.
+ * @tparam T Element type
+ * @tparam Alignment Must be a power of two
+ */
+template<typename T, std::size_t Alignment = cache_line_size>
+class AlignedAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator () noexcept = default;
+
+  template<typename U>
+  AlignedAllocator (const AlignedAllocator<U, Alignment> &) noexcept
+  {}
+
+  T *
+  allocate (std::size_t n)
+  {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void
+  deallocate (T *p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template<typename U>
+  bool
+  operator== (const AlignedAllocator<U, Alignment> &) const noexcept
+  {
+    return true;
+  }
+
+  template<typename U>
+  bool
+  operator!= (const AlignedAllocator<U, Alignment> &) const noexcept
+  {
+    return false;
+  }
+}; /* class AlignedAllocator */
+
+template<typename T>
+using aligned_vector = std::vector<T, AlignedAllocator<T> >;
+
+/**
+ * Hint that the cache line holding addr will be read soon. This is a no-op
+ * on compilers without a prefetch builtin.
+ * @param addr Need not point to valid memory
+ */
+inline void
+prefetch (const void *addr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(addr, 0, 3);
+#else
+  (void) addr;
+#endif
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_CACHE_UTILS_HPP
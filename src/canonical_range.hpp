@@ -0,0 +1,535 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Canonical forms of NumericRange that fix every bound kind, so that hot
+ * paths compare bound values only. An integral range with any combination
+ * of inclusive and exclusive bounds covers the same values as a half-open
+ * range [lb, ub), except at the top of the domain where ub would overflow.
+ * A floating point range covers the same values as the closed range whose
+ * exclusive bounds are moved inwards to the adjacent representable value.
+ */
+
+#ifndef NUMERIC_RANGE_CANONICAL_RANGE_HPP
+#define NUMERIC_RANGE_CANONICAL_RANGE_HPP
+
+#include "cache_utils.hpp"
+#include "interleaved_search.hpp"
+#include "interpolation_search.hpp"
+#include "numeric_range.hpp"
+#include "static_range.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * Convert an integral range to the half-open range covering the same values,
+ * without throwing. This fails for ranges that include the largest value of
+ * T, whose exclusive upper bound is not representable, and for ranges that
+ * contain no integer at all, such as (0, 1).
+ * Canonical ranges are compared with HalfOpenRangeComparator<T>, which
+ * needs one or two comparisons of bound values and no flag logic.
+ * @param range
+ * @param out Set to the half-open range on success, unchanged otherwise
+ * @return Whether range has a half-open form
+ */
+template<typename T>
+bool
+try_to_half_open (const NumericRange<T> &range, HalfOpenRange<T> &out) noexcept
+{
+  static_assert(std::is_integral<T>::value,
+                "Half-open canonicalization requires an integral type");
+  if (range.ub_inclusive && range.ub == std::numeric_limits<T>::max())
+  {
+    return false;
+  }
+  const T lb = detail::closed_lb(range);
+  const T ub = range.ub_inclusive ? T(range.ub + 1) : range.ub;
+  if (!(lb < ub))
+  {
+    return false;
+  }
+  out.lb = lb;
+  out.ub = ub;
+  return true;
+}
+
+/**
+ * Convert an integral range to the half-open range covering the same
+ * values. Convert back with the explicit conversion of HalfOpenRange<T> to
+ * NumericRange<T>, which yields [lb, ub).
+ * @param range
+ * @return The half-open form of range
+ * @throws overflow_error If range includes the largest value of T
+ * @throws runtime_error If range contains no integer
+ */
+template<typename T>
+HalfOpenRange<T>
+to_half_open (const NumericRange<T> &range)
+{
+  static_assert(std::is_integral<T>::value,
+                "Half-open canonicalization requires an integral type");
+  if (range.ub_inclusive && range.ub == std::numeric_limits<T>::max())
+  {
+    NUMERIC_RANGE_THROW(std::overflow_error(
+        "Range includes the largest value of its type and has no half-open "
+        "form"));
+  }
+  const T lb = detail::closed_lb(range);
+  const T ub = range.ub_inclusive ? T(range.ub + 1) : range.ub;
+  if (!(lb < ub))
+  {
+    NUMERIC_RANGE_THROW(std::runtime_error(
+        "Range contains no integer and has no half-open form"));
+  }
+  return HalfOpenRange<T>(lb, ub);
+}
+
+/**
+ * An immutable index answering "which range contains x" for sorted,
+ * non-overlapping integral ranges, stored in half-open canonical form. A
+ * lookup is a search over the lower bounds, branch-free unless an
+ * interpolating SearchStrategy is chosen, followed by one comparison with an
+ * upper bound.
+ * The top of the domain is handled explicitly: since ranges are disjoint,
+ * only the last one can include the largest value of T. Its upper bound is
+ * then stored as that value, and a single flag of the index admits it.
+ * Ranges that contain no integer are kept, so that positions match the
+ * input, but never match.
+ * @tparam T An integral type.
+ */
+template<typename T>
+class HalfOpenRangeIndex
+{
+  static_assert(std::is_integral<T>::value,
+                "HalfOpenRangeIndex requires an integral type");
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  HalfOpenRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass.
+   * @param first
+   * @param last
+   * @param strategy How find() searches the lower bounds
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has npos or more elements
+   */
+  template<typename InputIt>
+  HalfOpenRangeIndex (InputIt first, InputIt last,
+                      SearchStrategy strategy = SearchStrategy::binary) :
+      strategy_(strategy)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit HalfOpenRangeIndex (const std::vector<NumericRange<T> > &sorted,
+                               SearchStrategy strategy = SearchStrategy::binary) :
+      HalfOpenRangeIndex(sorted.begin(), sorted.end(), strategy)
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same semantics as
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    const std::size_t size = lb_.size();
+    if (size == 0)
+    {
+      return npos;
+    }
+    return resolve(x, detail::search_sorted(lb_.data(), size, x, strategy_));
+  }
+
+  /**
+   * Look up many scalars at once in a table much larger than the cache.
+   * group searches advance in lock-step, each prefetching its next probe,
+   * so that their memory accesses overlap. Equivalent to calling find() for
+   * every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   * @param group Number of searches in flight, at most 64
+   */
+  void
+  lookup_interleaved (const T *keys, std::size_t n, index_type *out,
+                      std::size_t group = detail::default_lookup_group) const
+  {
+    if (lb_.empty())
+    {
+      std::fill(out, out + n, npos);
+      return;
+    }
+    detail::interleaved_sorted_search(
+        lb_.data(), lb_.size(), keys, n, group,
+        [this, keys, out] (std::size_t i, std::size_t base) {
+          out[i] = resolve(keys[i], base);
+        });
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  std::size_t size () const { return lb_.size(); }
+  bool empty () const { return lb_.empty(); }
+
+  SearchStrategy strategy () const { return strategy_; }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity()) * sizeof(T);
+  }
+
+private:
+  SearchStrategy strategy_ = SearchStrategy::binary;
+  detail::aligned_vector<T> lb_;
+  detail::aligned_vector<T> ub_;
+  bool includes_max_ = false;
+
+  /**
+   * @param x
+   * @param base Last position with a lower bound <= x, or 0
+   */
+  index_type
+  resolve (const T x, std::size_t base) const
+  {
+    // Only the last range can satisfy the second alternative
+    const bool at_max = x == std::numeric_limits<T>::max();
+    const bool below_ub = (x < ub_[base]) | (includes_max_ & at_max);
+    return (lb_[base] <= x) & below_ub ? index_type(base) : npos;
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n >= npos)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for HalfOpenRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+
+    lb_.reserve(n);
+    ub_.reserve(n);
+    for (; first != last; ++first)
+    {
+      const NumericRange<T> &range = *first;
+      const bool top = range.ub_inclusive
+                       && range.ub == std::numeric_limits<T>::max();
+      lb_.push_back(detail::closed_lb(range));
+      ub_.push_back(range.ub_inclusive && !top ? T(range.ub + 1) : range.ub);
+      includes_max_ = top;
+    }
+  }
+}; /* class HalfOpenRangeIndex */
+
+/**
+ * Convert a floating point range to the closed range covering the same
+ * values, without throwing. Exclusive bounds are replaced by the adjacent
+ * representable value inside the range, e.g. [0, 1) becomes
+ * [0, nextafter(1, 0)]. This fails for open ranges between two adjacent
+ * representable values, which contain no value at all.
+ * Canonical ranges are compared with ClosedRangeComparator<T>, which needs
+ * one or two comparisons of bound values and no flag logic.
+ * @param range
+ * @param out Set to the closed range on success, unchanged otherwise
+ * @return Whether range has a closed form
+ */
+template<typename T>
+bool
+try_to_closed (const NumericRange<T> &range, ClosedRange<T> &out) noexcept
+{
+  static_assert(std::is_floating_point<T>::value,
+                "Closed canonicalization requires a floating point type");
+  const T lb = detail::closed_lb(range);
+  const T ub = detail::closed_ub(range);
+  if (!(lb <= ub))
+  {
+    return false;
+  }
+  out.lb = lb;
+  out.ub = ub;
+  return true;
+}
+
+/**
+ * Convert a floating point range to the closed range covering the same
+ * values. Convert back with from_closed and the original bound kinds.
+ * @param range
+ * @return The closed form of range
+ * @throws runtime_error If range contains no representable value
+ */
+template<typename T>
+ClosedRange<T>
+to_closed (const NumericRange<T> &range)
+{
+  static_assert(std::is_floating_point<T>::value,
+                "Closed canonicalization requires a floating point type");
+  const T lb = detail::closed_lb(range);
+  const T ub = detail::closed_ub(range);
+  if (!(lb <= ub))
+  {
+    NUMERIC_RANGE_THROW(std::runtime_error(
+        "Range contains no representable value and has no closed form"));
+  }
+  return ClosedRange<T>(lb, ub);
+}
+
+/**
+ * Inverse of to_closed: the range with the given bound kinds that covers the
+ * same values as closed. from_closed(to_closed(r), r.lb_inclusive,
+ * r.ub_inclusive) compares equal to r. Also inverts closed bounds obtained
+ * from try_to_closed or ClosedRangeIndex.
+ * @param closed
+ * @param lb_inclusive
+ * @param ub_inclusive
+ * @return The range with the original bounds
+ */
+template<typename T>
+NumericRange<T>
+from_closed (const ClosedRange<T> &closed, const bool lb_inclusive,
+             const bool ub_inclusive)
+{
+  static_assert(std::is_floating_point<T>::value,
+                "Closed canonicalization requires a floating point type");
+  const T inf = std::numeric_limits<T>::infinity();
+  return NumericRange<T>(
+      lb_inclusive ? closed.lb : std::nextafter(closed.lb, -inf), lb_inclusive,
+      ub_inclusive ? closed.ub : std::nextafter(closed.ub, inf), ub_inclusive);
+}
+
+/**
+ * An immutable index answering "which range contains x" for sorted,
+ * non-overlapping floating point ranges, stored in closed canonical form.
+ * A lookup is a search comparing lower bounds with <= (see SearchStrategy),
+ * followed by one <= comparison with an upper bound, and NaN never matches.
+ * The bound columns are exposed so that callers can classify values with
+ * plain SIMD compares, and the original bound kinds are kept aside so that
+ * every range converts back exactly.
+ * Ranges that contain no representable value are kept, so that positions
+ * match the input, but never match.
+ * @tparam T A floating point type.
+ */
+template<typename T>
+class ClosedRangeIndex
+{
+  static_assert(std::is_floating_point<T>::value,
+                "ClosedRangeIndex requires a floating point type");
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  ClosedRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass.
+   * @param first
+   * @param last
+   * @param strategy How find() searches the lower bounds
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has npos or more elements
+   */
+  template<typename InputIt>
+  ClosedRangeIndex (InputIt first, InputIt last,
+                    SearchStrategy strategy = SearchStrategy::binary) :
+      strategy_(strategy)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit ClosedRangeIndex (const std::vector<NumericRange<T> > &sorted,
+                             SearchStrategy strategy = SearchStrategy::binary) :
+      ClosedRangeIndex(sorted.begin(), sorted.end(), strategy)
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same semantics as
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    const std::size_t size = lb_.size();
+    if (size == 0)
+    {
+      return npos;
+    }
+    return resolve(x, detail::search_sorted(lb_.data(), size, x, strategy_));
+  }
+
+  /**
+   * Look up many scalars at once in a table much larger than the cache.
+   * group searches advance in lock-step, each prefetching its next probe,
+   * so that their memory accesses overlap. Equivalent to calling find() for
+   * every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   * @param group Number of searches in flight, at most 64
+   */
+  void
+  lookup_interleaved (const T *keys, std::size_t n, index_type *out,
+                      std::size_t group = detail::default_lookup_group) const
+  {
+    if (lb_.empty())
+    {
+      std::fill(out, out + n, npos);
+      return;
+    }
+    detail::interleaved_sorted_search(
+        lb_.data(), lb_.size(), keys, n, group,
+        [this, keys, out] (std::size_t i, std::size_t base) {
+          out[i] = resolve(keys[i], base);
+        });
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  /**
+   * @param pos
+   * @return The range at pos with its original bounds and bound kinds
+   */
+  NumericRange<T>
+  range (std::size_t pos) const
+  {
+    const std::uint8_t kinds = kinds_[pos];
+    // Assigned after construction since empty ranges have lb > ub
+    ClosedRange<T> closed(lb_[pos], lb_[pos]);
+    closed.ub = ub_[pos];
+    return from_closed(closed, kinds & lb_inclusive_bit,
+                       kinds & ub_inclusive_bit);
+  }
+
+  /**
+   * @return Contiguous array of size() closed lower bounds
+   */
+  const T *lbs () const { return lb_.data(); }
+
+  /**
+   * @return Contiguous array of size() closed upper bounds
+   */
+  const T *ubs () const { return ub_.data(); }
+
+  std::size_t size () const { return lb_.size(); }
+  bool empty () const { return lb_.empty(); }
+
+  SearchStrategy strategy () const { return strategy_; }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity()) * sizeof(T) + kinds_.capacity();
+  }
+
+private:
+  static constexpr std::uint8_t lb_inclusive_bit = 1;
+  static constexpr std::uint8_t ub_inclusive_bit = 2;
+
+  SearchStrategy strategy_ = SearchStrategy::binary;
+  detail::aligned_vector<T> lb_;
+  detail::aligned_vector<T> ub_;
+  std::vector<std::uint8_t> kinds_;
+
+  /**
+   * @param x
+   * @param base Last position with a lower bound <= x, or 0
+   */
+  index_type
+  resolve (const T x, std::size_t base) const
+  {
+    return (lb_[base] <= x) & (x <= ub_[base]) ? index_type(base) : npos;
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n >= npos)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for ClosedRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+
+    lb_.reserve(n);
+    ub_.reserve(n);
+    kinds_.reserve(n);
+    for (; first != last; ++first)
+    {
+      const NumericRange<T> &range = *first;
+      lb_.push_back(detail::closed_lb(range));
+      ub_.push_back(detail::closed_ub(range));
+      kinds_.push_back(std::uint8_t(
+          (range.lb_inclusive ? lb_inclusive_bit : 0)
+          | (range.ub_inclusive ? ub_inclusive_bit : 0)));
+    }
+  }
+}; /* class ClosedRangeIndex */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_CANONICAL_RANGE_HPP
@@ -0,0 +1,329 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A range map for read-mostly workloads shared between threads. Readers
+ * look up values in an immutable RangeMap snapshot without taking locks,
+ * and writers publish new snapshots in the style of read-copy-update (RCU).
+ */
+
+#ifndef NUMERIC_RANGE_CONCURRENT_RANGE_MAP_HPP
+#define NUMERIC_RANGE_CONCURRENT_RANGE_MAP_HPP
+
+#include "cache_utils.hpp"
+#include "numeric_range.hpp"
+#include "range_map.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A ConcurrentRangeMap holds the current version of an immutable
+ * RangeMap<T, V>. Any number of reader threads query it concurrently with
+ * writers that replace it wholesale:
+ * - Each reader thread obtains a Reader once through reader(). Lookups
+ *   through a Reader are wait-free: they announce the current epoch in a
+ *   slot owned by that reader, load the snapshot pointer and clear the slot
+ *   afterwards, with no locks, retries or shared counters.
+ * - Writers build a new RangeMap and publish() it with one atomic pointer
+ *   swap. The previous version is retired and deleted once no reader that
+ *   may still be using it remains, which is checked on later publishes,
+ *   on reclaim() and on synchronize().
+ * Writers are serialized by a mutex. The map must outlive its Readers, and
+ * may only be destroyed while no read is in progress.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam V Mapped value type.
+ */
+template<typename T, typename V>
+class ConcurrentRangeMap
+{
+  /**
+   * Per-reader announcement of the epoch in which its current read began,
+   * or 0 between reads. Aligned to a cache line so that readers never share
+   * one.
+   */
+  struct alignas(detail::cache_line_size) Slot
+  {
+    std::atomic<std::uint64_t> epoch{0};
+    std::atomic<bool> in_use{false};
+    Slot *next = nullptr;
+  };
+
+  struct Retired
+  {
+    const RangeMap<T, V> *map;
+    // Epoch that began when map was replaced
+    std::uint64_t epoch;
+  };
+
+public:
+  using map_type = RangeMap<T, V>;
+
+  /**
+   * A handle through which one thread reads the map. Obtain one per thread
+   * and keep it for as long as the thread reads; it is not thread-safe
+   * itself.
+   */
+  class Reader
+  {
+  public:
+    Reader (Reader &&other) noexcept :
+        slot_(std::exchange(other.slot_, nullptr)), owner_(other.owner_)
+    {}
+
+    Reader &
+    operator= (Reader &&other) noexcept
+    {
+      release();
+      slot_ = std::exchange(other.slot_, nullptr);
+      owner_ = other.owner_;
+      return *this;
+    }
+
+    Reader (const Reader &) = delete;
+    Reader &operator= (const Reader &) = delete;
+
+    ~Reader () { release(); }
+
+    /**
+     * Call f with the current snapshot and return its result. The snapshot
+     * stays valid until f returns, and references into it must not escape.
+     * Calls must not be nested on one Reader.
+     * @param f Callable taking a const map_type &
+     */
+    template<typename F>
+    decltype(auto)
+    read (F &&f) const
+    {
+      struct Exit
+      {
+        Slot *slot;
+        ~Exit () { slot->epoch.store(0, std::memory_order_release); }
+      } exit{slot_};
+      // Announce before loading the snapshot, so that a writer that does
+      // not see the announcement has already published a newer snapshot.
+      slot_->epoch.store(owner_->epoch_.load(std::memory_order_acquire),
+                         std::memory_order_seq_cst);
+      const map_type *map = owner_->current_.load(std::memory_order_seq_cst);
+      return f(*map);
+    }
+
+    /**
+     * @param x
+     * @return Copy of the value mapped to the range containing x, if any
+     */
+    std::optional<V>
+    find (const T &x) const
+    {
+      return read([&x] (const map_type &map) -> std::optional<V> {
+        const auto it = map.find(x);
+        if (it == map.end())
+        {
+          return std::nullopt;
+        }
+        return it->second;
+      });
+    }
+
+    bool
+    contains (const T &x) const
+    {
+      return read([&x] (const map_type &map) { return map.contains(x); });
+    }
+
+  private:
+    friend class ConcurrentRangeMap;
+
+    Slot *slot_;
+    const ConcurrentRangeMap *owner_;
+
+    Reader (Slot *slot, const ConcurrentRangeMap *owner) :
+        slot_(slot), owner_(owner)
+    {}
+
+    void
+    release ()
+    {
+      if (slot_ != nullptr)
+      {
+        slot_->in_use.store(false, std::memory_order_release);
+        slot_ = nullptr;
+      }
+    }
+  }; /* class Reader */
+
+  ConcurrentRangeMap () : ConcurrentRangeMap(map_type()) {}
+
+  explicit ConcurrentRangeMap (map_type map) :
+      current_(new map_type(std::move(map)))
+  {}
+
+  ConcurrentRangeMap (const ConcurrentRangeMap &) = delete;
+  ConcurrentRangeMap &operator= (const ConcurrentRangeMap &) = delete;
+
+  ~ConcurrentRangeMap ()
+  {
+    delete current_.load();
+    for (const Retired &r : retired_)
+    {
+      delete r.map;
+    }
+    Slot *slot = slots_.load();
+    while (slot != nullptr)
+    {
+      delete std::exchange(slot, slot->next);
+    }
+  }
+
+  /**
+   * Register a reader, reusing the slot of a destroyed Reader if possible.
+   * This is the only operation on the read side that may allocate.
+   * @return A Reader for use by one thread
+   */
+  Reader
+  reader () const
+  {
+    for (Slot *slot = slots_.load(std::memory_order_acquire); slot != nullptr;
+         slot = slot->next)
+    {
+      bool expected = false;
+      if (!slot->in_use.load(std::memory_order_relaxed)
+          && slot->in_use.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire))
+      {
+        return Reader(slot, this);
+      }
+    }
+    Slot *slot = new Slot;
+    slot->in_use.store(true, std::memory_order_relaxed);
+    slot->next = slots_.load(std::memory_order_relaxed);
+    while (!slots_.compare_exchange_weak(slot->next, slot,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed))
+    {}
+    return Reader(slot, this);
+  }
+
+  /**
+   * Replace the current version with map. Readers that already hold the
+   * previous version keep using it until their read ends; the previous
+   * version is then deleted by a later publish, reclaim or synchronize.
+   * @param map
+   */
+  void
+  publish (map_type map)
+  {
+    const map_type *next = new map_type(std::move(map));
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    publish_locked(next);
+  }
+
+  /**
+   * Publish a modified copy of the current version. Concurrent publishes
+   * wait, so no update is lost.
+   * @param f Callable taking a map_type & to modify
+   */
+  template<typename F>
+  void
+  update (F &&f)
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto next = std::make_unique<map_type>(
+        *current_.load(std::memory_order_relaxed));
+    f(*next);
+    publish_locked(next.release());
+  }
+
+  /**
+   * Delete every retired version that no reader can still be using.
+   * @return Number of retired versions still pending
+   */
+  std::size_t
+  reclaim ()
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return reclaim_locked();
+  }
+
+  /**
+   * Wait until all reads that began before this call have ended, and delete
+   * the versions they used.
+   */
+  void
+  synchronize ()
+  {
+    while (reclaim() != 0)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  std::atomic<const map_type *> current_;
+  // Starts at 1 so that a slot holding 0 is never mistaken for a reader
+  std::atomic<std::uint64_t> epoch_{1};
+  mutable std::atomic<Slot *> slots_{nullptr};
+  std::mutex write_mutex_;
+  std::vector<Retired> retired_;
+
+  void
+  publish_locked (const map_type *next)
+  {
+    const map_type *previous = current_.exchange(next,
+                                                 std::memory_order_seq_cst);
+    // Readers that announce this epoch or later load next or a successor
+    const std::uint64_t epoch = epoch_.fetch_add(1, std::memory_order_seq_cst)
+                                + 1;
+    retired_.push_back({previous, epoch});
+    reclaim_locked();
+  }
+
+  std::size_t
+  reclaim_locked ()
+  {
+    if (retired_.empty())
+    {
+      return 0;
+    }
+    // A version retired at epoch e can only be in use by a reader that
+    // announced an epoch before e.
+    std::uint64_t oldest = epoch_.load(std::memory_order_seq_cst);
+    for (Slot *slot = slots_.load(std::memory_order_acquire); slot != nullptr;
+         slot = slot->next)
+    {
+      const std::uint64_t epoch = slot->epoch.load(std::memory_order_seq_cst);
+      if (epoch != 0 && epoch < oldest)
+      {
+        oldest = epoch;
+      }
+    }
+    std::size_t kept = 0;
+    for (const Retired &r : retired_)
+    {
+      if (r.epoch <= oldest)
+      {
+        delete r.map;
+      }
+      else
+      {
+        retired_[kept++] = r;
+      }
+    }
+    retired_.resize(kept);
+    return kept;
+  }
+}; /* class ConcurrentRangeMap */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_CONCURRENT_RANGE_MAP_HPP
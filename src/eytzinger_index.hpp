@@ -0,0 +1,248 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A frozen, read-only index over sorted, non-overlapping NumericRange objects
+ * whose bounds are stored in Eytzinger (breadth-first) order. The top levels
+ * of the implicit search tree share a handful of cache lines, and the nodes
+ * visited a few levels further down are adjacent in memory, so they can be
+ * prefetched while the current level is still being compared.
+ */
+
+#ifndef NUMERIC_RANGE_EYTZINGER_INDEX_HPP
+#define NUMERIC_RANGE_EYTZINGER_INDEX_HPP
+
+#include "cache_utils.hpp"
+#include "eytzinger_simd.hpp"
+#include "interleaved_search.hpp"
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * An immutable index answering "which range contains x" for a set of sorted,
+ * non-overlapping ranges. Positions returned refer to the order of the
+ * sequence the index was built from, so values can be kept in a parallel
+ * array by the caller.
+ * Internally each range is reduced to its closed bounds (see
+ * detail::closed_lb and detail::closed_ub), which makes lookups pure
+ * comparisons without any branching on bound inclusivity.
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+class EytzingerRangeIndex
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "EytzingerRangeIndex requires an arithmetic type");
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  EytzingerRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass. Sequences with
+   * forward iterators are read in place; others are copied first.
+   * @param first
+   * @param last
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has npos or more elements
+   */
+  template<typename InputIt>
+  EytzingerRangeIndex (InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit EytzingerRangeIndex (const std::vector<NumericRange<T> > &sorted) :
+      EytzingerRangeIndex(sorted.begin(), sorted.end())
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same inclusive/exclusive
+   * semantics as NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    const T *lo = lo_.data();
+    std::size_t k = 1;
+    std::size_t candidate = 0;
+    while (k <= n_)
+    {
+      detail::prefetch(lo + std::min(k * prefetch_stride, n_));
+      const bool right = lo[k] <= x;
+      candidate = right ? k : candidate;
+      k = 2 * k + right;
+    }
+    return resolve(x, candidate);
+  }
+
+  /**
+   * Look up many scalars at once. On x86-64 CPUs with AVX2 or AVX-512 and
+   * for 32/64-bit signed integer or floating point T, several lookups are
+   * processed per instruction; otherwise this is equivalent to calling
+   * find() for every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   */
+  void
+  lookup_batch (const T *keys, std::size_t n, index_type *out) const
+  {
+    static_assert(sizeof(index_type) == sizeof(std::uint32_t),
+                  "SIMD kernels produce 32-bit positions");
+    const detail::EytzingerView<T> view{lo_.data(), hi_.data(), rank_.data(),
+                                        n_, height_};
+    std::size_t done = detail::eytzinger_batch_simd(view, keys, n, out);
+    for (; done < n; ++done)
+    {
+      out[done] = find(keys[done]);
+    }
+  }
+
+  /**
+   * Look up many scalars at once in a table much larger than the cache.
+   * group searches advance through the tree in lock-step, each prefetching
+   * its next node, so that their memory accesses overlap. Equivalent to
+   * calling find() for every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   * @param group Number of searches in flight, at most 64
+   */
+  void
+  lookup_interleaved (const T *keys, std::size_t n, index_type *out,
+                      std::size_t group = detail::default_lookup_group) const
+  {
+    detail::interleaved_eytzinger_search(
+        lo_.data(), n_, height_, keys, n, group,
+        [this, keys, out] (std::size_t i, std::size_t candidate) {
+          out[i] = resolve(keys[i], candidate);
+        });
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  std::size_t size () const { return n_; }
+  bool empty () const { return n_ == 0; }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return lo_.capacity() * sizeof(T) + hi_.capacity() * sizeof(T)
+           + rank_.capacity() * sizeof(index_type);
+  }
+
+private:
+  // The descendants of k that are log2(stride) levels down occupy the
+  // stride consecutive slots starting at k * stride, i.e. one cache line.
+  static constexpr std::size_t prefetch_stride =
+      detail::cache_line_size / sizeof(T);
+
+  std::size_t n_ = 0;
+  unsigned height_ = 0;
+  detail::aligned_vector<T> lo_;
+  detail::aligned_vector<T> hi_;
+  detail::aligned_vector<index_type> rank_;
+
+  /**
+   * @param x
+   * @param candidate Last node of the search path with lo <= x, or 0
+   */
+  index_type
+  resolve (const T x, std::size_t candidate) const
+  {
+    // NaN never satisfies lo <= x, so it ends up here as well.
+    if (candidate == 0 || !(x <= hi_[candidate]))
+    {
+      return npos;
+    }
+    return rank_[candidate];
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n >= npos)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for EytzingerRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+
+    n_ = n;
+    height_ = 0;
+    while ((std::size_t(1) << height_) <= n_)
+    {
+      ++height_;
+    }
+    // Slot 0 is unused so that the children of node k are 2k and 2k + 1.
+    lo_.assign(n_ + 1, T());
+    hi_.assign(n_ + 1, T());
+    rank_.assign(n_ + 1, npos);
+    std::size_t next = 0;
+    fill(first, 1, next);
+  }
+
+  /**
+   * In-order traversal of the implicit tree rooted at k, assigning sorted
+   * elements in ascending order. it refers to element next of the input.
+   */
+  template<typename ForwardIt>
+  void
+  fill (ForwardIt &it, std::size_t k, std::size_t &next)
+  {
+    if (k > n_)
+    {
+      return;
+    }
+    fill(it, 2 * k, next);
+    lo_[k] = detail::closed_lb(*it);
+    hi_[k] = detail::closed_ub(*it);
+    rank_[k] = index_type(next);
+    ++it;
+    ++next;
+    fill(it, 2 * k + 1, next);
+  }
+}; /* class EytzingerRangeIndex */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_EYTZINGER_INDEX_HPP
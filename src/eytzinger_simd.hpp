@@ -0,0 +1,360 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * AVX2 and AVX-512 kernels for batched lookups in an EytzingerRangeIndex.
+ * Every lane descends the implicit tree independently using gathers, for
+ * as many steps as the tree has levels. The tree is complete up to its
+ * last level, which may be partial, so on the last step some lanes run past
+ * node_count: a mask of the lanes still inside the tree keeps the others
+ * out of the gathers and stops them from advancing. The final gathers of
+ * upper bounds and positions are likewise masked to the lanes that found a
+ * candidate, so no kernel reads slot 0 or past the end of the tree.
+ */
+
+#ifndef NUMERIC_RANGE_EYTZINGER_SIMD_HPP
+#define NUMERIC_RANGE_EYTZINGER_SIMD_HPP
+
+#include "simd_dispatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace numeric_range {
+
+namespace detail {
+
+/**
+ * Read-only view of the arrays of an EytzingerRangeIndex, 1-indexed.
+ */
+template<typename T>
+struct EytzingerView
+{
+  const T *lo;
+  const T *hi;
+  const std::uint32_t *rank;
+  std::size_t n;
+  unsigned height;
+};
+
+#ifdef NUMERIC_RANGE_X86_SIMD
+
+/*
+ * 32-bit keys use 32-bit lane indices, which requires 2n + 1 to fit into a
+ * signed 32-bit integer. Callers must fall back to another kernel otherwise.
+ */
+constexpr std::size_t simd_max_n_32 = (std::size_t(1) << 30);
+
+// Lanes outside of active are not gathered and compare against zero
+template<typename T>
+__attribute__((target("avx2"))) inline __m256i
+avx2_le_32 (__m256i idx, __m256i active, const T *lo, __m256i x_bits)
+{
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    const __m256 l = _mm256_mask_i32gather_ps(
+        _mm256_setzero_ps(), lo, idx, _mm256_castsi256_ps(active), 4);
+    return _mm256_castps_si256(
+        _mm256_cmp_ps(l, _mm256_castsi256_ps(x_bits), _CMP_LE_OQ));
+  }
+  else
+  {
+    const __m256i l = _mm256_mask_i32gather_epi32(
+        _mm256_setzero_si256(), reinterpret_cast<const int *>(lo), idx,
+        active, 4);
+    return _mm256_xor_si256(_mm256_cmpgt_epi32(l, x_bits),
+                            _mm256_set1_epi32(-1));
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline void
+eytzinger_batch_avx2_32 (const EytzingerView<T> &v, const T *keys,
+                         std::size_t count, std::uint32_t *out)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i n_plus_one = _mm256_set1_epi32(int(v.n + 1));
+  const __m256i npos = _mm256_set1_epi32(-1);
+
+  for (std::size_t i = 0; i + 8 <= count; i += 8)
+  {
+    const __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(keys + i));
+    __m256i k = one;
+    __m256i candidate = zero;
+    for (unsigned level = 0; level < v.height; ++level)
+    {
+      const __m256i active = _mm256_cmpgt_epi32(n_plus_one, k);
+      const __m256i right = _mm256_and_si256(
+          active, avx2_le_32(k, active, v.lo, x));
+      candidate = _mm256_blendv_epi8(candidate, k, right);
+      // right is all ones (-1) when true
+      const __m256i next = _mm256_sub_epi32(_mm256_add_epi32(k, k), right);
+      k = _mm256_blendv_epi8(k, next, active);
+    }
+    const __m256i found = _mm256_xor_si256(_mm256_cmpeq_epi32(candidate, zero),
+                                           npos);
+    // x <= hi is the same as hi >= x, i.e. !(x > hi) for integers
+    __m256i inside;
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      const __m256 h = _mm256_mask_i32gather_ps(
+          _mm256_setzero_ps(), v.hi, candidate, _mm256_castsi256_ps(found),
+          4);
+      inside = _mm256_castps_si256(
+          _mm256_cmp_ps(_mm256_castsi256_ps(x), h, _CMP_LE_OQ));
+    }
+    else
+    {
+      const __m256i h = _mm256_mask_i32gather_epi32(
+          zero, reinterpret_cast<const int *>(v.hi), candidate, found, 4);
+      inside = _mm256_xor_si256(_mm256_cmpgt_epi32(x, h), npos);
+    }
+    const __m256i result = _mm256_mask_i32gather_epi32(
+        npos, reinterpret_cast<const int *>(v.rank), candidate,
+        _mm256_and_si256(found, inside), 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline void
+eytzinger_batch_avx2_64 (const EytzingerView<T> &v, const T *keys,
+                         std::size_t count, std::uint32_t *out)
+{
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i one = _mm256_set1_epi64x(1);
+  const __m256i n = _mm256_set1_epi64x((long long) v.n);
+  const __m256i all = _mm256_set1_epi64x(-1);
+  const auto *lo = reinterpret_cast<const long long *>(v.lo);
+  const auto *hi = reinterpret_cast<const long long *>(v.hi);
+
+  for (std::size_t i = 0; i + 4 <= count; i += 4)
+  {
+    const __m256i x = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(keys + i));
+    __m256i k = one;
+    __m256i candidate = zero;
+    for (unsigned level = 0; level < v.height; ++level)
+    {
+      const __m256i active = _mm256_xor_si256(_mm256_cmpgt_epi64(k, n), all);
+      __m256i le;
+      if constexpr (std::is_floating_point<T>::value)
+      {
+        const __m256d l = _mm256_mask_i64gather_pd(
+            _mm256_setzero_pd(), v.lo, k, _mm256_castsi256_pd(active), 8);
+        le = _mm256_castpd_si256(
+            _mm256_cmp_pd(l, _mm256_castsi256_pd(x), _CMP_LE_OQ));
+      }
+      else
+      {
+        const __m256i l = _mm256_mask_i64gather_epi64(zero, lo, k, active, 8);
+        le = _mm256_xor_si256(_mm256_cmpgt_epi64(l, x), all);
+      }
+      const __m256i right = _mm256_and_si256(active, le);
+      candidate = _mm256_blendv_epi8(candidate, k, right);
+      const __m256i next = _mm256_sub_epi64(_mm256_add_epi64(k, k), right);
+      k = _mm256_blendv_epi8(k, next, active);
+    }
+    const __m256i found = _mm256_xor_si256(
+        _mm256_cmpeq_epi64(candidate, zero), all);
+    __m256i inside;
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      const __m256d h = _mm256_mask_i64gather_pd(
+          _mm256_setzero_pd(), v.hi, candidate, _mm256_castsi256_pd(found), 8);
+      inside = _mm256_castpd_si256(
+          _mm256_cmp_pd(_mm256_castsi256_pd(x), h, _CMP_LE_OQ));
+    }
+    else
+    {
+      const __m256i h = _mm256_mask_i64gather_epi64(zero, hi, candidate, found,
+                                                    8);
+      inside = _mm256_xor_si256(_mm256_cmpgt_epi64(x, h), all);
+    }
+    const __m256i match = _mm256_and_si256(found, inside);
+    // Narrow the 64-bit match mask to 32-bit lanes
+    const __m128i match32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+        match, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6)));
+    const __m128i result = _mm256_mask_i64gather_epi32(
+        _mm_set1_epi32(-1), reinterpret_cast<const int *>(v.rank), candidate,
+        match32, 4);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), result);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+eytzinger_batch_avx512_32 (const EytzingerView<T> &v, const T *keys,
+                           std::size_t count, std::uint32_t *out)
+{
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi32(1);
+  const __m512i n = _mm512_set1_epi32(int(v.n));
+  const __m512i npos = _mm512_set1_epi32(-1);
+
+  for (std::size_t i = 0; i + 16 <= count; i += 16)
+  {
+    const __m512i x = _mm512_loadu_si512(keys + i);
+    __m512i k = one;
+    __m512i candidate = zero;
+    for (unsigned level = 0; level < v.height; ++level)
+    {
+      const __mmask16 active = _mm512_cmple_epi32_mask(k, n);
+      __mmask16 right;
+      if constexpr (std::is_floating_point<T>::value)
+      {
+        const __m512 l = _mm512_mask_i32gather_ps(
+            _mm512_setzero_ps(), active, k, v.lo, 4);
+        right = _mm512_mask_cmp_ps_mask(active, l, _mm512_castsi512_ps(x),
+                                        _CMP_LE_OQ);
+      }
+      else
+      {
+        const __m512i l = _mm512_mask_i32gather_epi32(zero, active, k, v.lo, 4);
+        right = _mm512_mask_cmple_epi32_mask(active, l, x);
+      }
+      candidate = _mm512_mask_mov_epi32(candidate, right, k);
+      k = _mm512_mask_add_epi32(k, active, k, k);
+      k = _mm512_mask_add_epi32(k, right, k, one);
+    }
+    const __mmask16 found = _mm512_cmpneq_epi32_mask(candidate, zero);
+    __mmask16 match;
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      const __m512 h = _mm512_mask_i32gather_ps(
+          _mm512_setzero_ps(), found, candidate, v.hi, 4);
+      match = _mm512_mask_cmp_ps_mask(found, _mm512_castsi512_ps(x), h,
+                                      _CMP_LE_OQ);
+    }
+    else
+    {
+      const __m512i h = _mm512_mask_i32gather_epi32(zero, found, candidate,
+                                                    v.hi, 4);
+      match = _mm512_mask_cmple_epi32_mask(found, x, h);
+    }
+    const __m512i result = _mm512_mask_i32gather_epi32(npos, match, candidate,
+                                                       v.rank, 4);
+    _mm512_storeu_si512(out + i, result);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+eytzinger_batch_avx512_64 (const EytzingerView<T> &v, const T *keys,
+                           std::size_t count, std::uint32_t *out)
+{
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512i one = _mm512_set1_epi64(1);
+  const __m512i n = _mm512_set1_epi64((long long) v.n);
+
+  for (std::size_t i = 0; i + 8 <= count; i += 8)
+  {
+    const __m512i x = _mm512_loadu_si512(keys + i);
+    __m512i k = one;
+    __m512i candidate = zero;
+    for (unsigned level = 0; level < v.height; ++level)
+    {
+      const __mmask8 active = _mm512_cmple_epi64_mask(k, n);
+      __mmask8 right;
+      if constexpr (std::is_floating_point<T>::value)
+      {
+        const __m512d l = _mm512_mask_i64gather_pd(
+            _mm512_setzero_pd(), active, k, v.lo, 8);
+        right = _mm512_mask_cmp_pd_mask(active, l, _mm512_castsi512_pd(x),
+                                        _CMP_LE_OQ);
+      }
+      else
+      {
+        const __m512i l = _mm512_mask_i64gather_epi64(zero, active, k, v.lo, 8);
+        right = _mm512_mask_cmple_epi64_mask(active, l, x);
+      }
+      candidate = _mm512_mask_mov_epi64(candidate, right, k);
+      k = _mm512_mask_add_epi64(k, active, k, k);
+      k = _mm512_mask_add_epi64(k, right, k, one);
+    }
+    const __mmask8 found = _mm512_cmpneq_epi64_mask(candidate, zero);
+    __mmask8 match;
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      const __m512d h = _mm512_mask_i64gather_pd(
+          _mm512_setzero_pd(), found, candidate, v.hi, 8);
+      match = _mm512_mask_cmp_pd_mask(found, _mm512_castsi512_pd(x), h,
+                                      _CMP_LE_OQ);
+    }
+    else
+    {
+      const __m512i h = _mm512_mask_i64gather_epi64(zero, found, candidate,
+                                                    v.hi, 8);
+      match = _mm512_mask_cmple_epi64_mask(found, x, h);
+    }
+    const __m256i result = _mm512_mask_i64gather_epi32(
+        _mm256_set1_epi32(-1), match, candidate, v.rank, 4);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+  }
+}
+
+#endif /* NUMERIC_RANGE_X86_SIMD */
+
+/**
+ * Run the widest available kernel over as many keys as it handles.
+ * @return Number of leading keys processed; the caller handles the rest
+ */
+template<typename T>
+std::size_t
+eytzinger_batch_simd (const EytzingerView<T> &v, const T *keys,
+                      std::size_t count, std::uint32_t *out)
+{
+#ifdef NUMERIC_RANGE_X86_SIMD
+  if constexpr (simd_key<T>::value)
+  {
+    const SimdLevel level = simd_level();
+    // An empty index has no tree for the kernels to read
+    if (v.n == 0 || (sizeof(T) == 4 && v.n >= simd_max_n_32))
+    {
+      return 0;
+    }
+    if (level == SimdLevel::avx512)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        eytzinger_batch_avx512_32(v, keys, count, out);
+        return count - count % 16;
+      }
+      else
+      {
+        eytzinger_batch_avx512_64(v, keys, count, out);
+        return count - count % 8;
+      }
+    }
+    if (level == SimdLevel::avx2)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        eytzinger_batch_avx2_32(v, keys, count, out);
+        return count - count % 8;
+      }
+      else
+      {
+        eytzinger_batch_avx2_64(v, keys, count, out);
+        return count - count % 4;
+      }
+    }
+  }
+#endif
+  (void) v;
+  (void) keys;
+  (void) count;
+  (void) out;
+  return 0;
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_EYTZINGER_SIMD_HPP
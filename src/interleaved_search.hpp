@@ -0,0 +1,127 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Interleaved searches for batched lookups in tables much larger than the
+ * cache (group prefetching). A group of independent searches advances in
+ * lock-step, one level at a time, and each search prefetches the element it
+ * reads at the next level before the group moves on. The memory latency of
+ * one search is thereby overlapped with the work of the others.
+ */
+
+#ifndef NUMERIC_RANGE_INTERLEAVED_SEARCH_HPP
+#define NUMERIC_RANGE_INTERLEAVED_SEARCH_HPP
+
+#include "cache_utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace numeric_range {
+
+namespace detail {
+
+// Enough to cover DRAM latency with the few instructions of one step
+constexpr std::size_t default_lookup_group = 16;
+
+// Upper bound for the group size, which sizes the per-group state
+constexpr std::size_t max_lookup_group = 64;
+
+/**
+ * Branch-free binary search of every key in a sorted array, group keys at a
+ * time. Since the number of steps only depends on size, all searches of a
+ * group take the same path length and no bookkeeping of finished searches
+ * is needed.
+ * @param bounds Sorted array of size > 0 elements
+ * @param size
+ * @param keys Array of n keys
+ * @param n
+ * @param group Number of searches in flight, clamped to [1, max_lookup_group]
+ * @param finish Called as finish(i, base) with the last position base
+ * holding a value <= keys[i], or 0 if there is none
+ */
+template<typename T, typename Finish>
+void
+interleaved_sorted_search (const T *bounds, std::size_t size, const T *keys,
+                           std::size_t n, std::size_t group, Finish &&finish)
+{
+  group = std::min(std::max<std::size_t>(group, 1), max_lookup_group);
+  std::size_t base[max_lookup_group];
+  for (std::size_t first = 0; first < n; first += group)
+  {
+    const std::size_t count = std::min(group, n - first);
+    const T *x = keys + first;
+    std::fill(base, base + count, std::size_t(0));
+    for (std::size_t m = size; m > 1; m -= m / 2)
+    {
+      const std::size_t half = m / 2;
+      const std::size_t next_half = (m - half) / 2;
+      for (std::size_t g = 0; g < count; ++g)
+      {
+        // Arithmetic rather than a select, which compilers tend to turn
+        // into an unpredictable branch when the result goes to memory
+        base[g] += half * std::size_t(bounds[base[g] + half] <= x[g]);
+        prefetch(bounds + base[g] + next_half);
+      }
+    }
+    for (std::size_t g = 0; g < count; ++g)
+    {
+      finish(first + g, base[g]);
+    }
+  }
+}
+
+/**
+ * Descent of an implicit Eytzinger tree for every key, group keys at a
+ * time. Searches in a group differ in length by at most the last level.
+ * @param lo 1-indexed array of nodes node_count + 1 elements long
+ * @param node_count
+ * @param height Number of levels of the tree
+ * @param keys Array of n keys
+ * @param n
+ * @param group Number of searches in flight, clamped to [1, max_lookup_group]
+ * @param finish Called as finish(i, candidate) with the last node whose
+ * value is <= keys[i], or 0 if there is none
+ */
+template<typename T, typename Finish>
+void
+interleaved_eytzinger_search (const T *lo, std::size_t node_count,
+                              unsigned height, const T *keys, std::size_t n,
+                              std::size_t group, Finish &&finish)
+{
+  group = std::min(std::max<std::size_t>(group, 1), max_lookup_group);
+  std::size_t k[max_lookup_group];
+  std::size_t candidate[max_lookup_group];
+  for (std::size_t first = 0; first < n; first += group)
+  {
+    const std::size_t count = std::min(group, n - first);
+    const T *x = keys + first;
+    std::fill(k, k + count, std::size_t(1));
+    std::fill(candidate, candidate + count, std::size_t(0));
+    for (unsigned level = 0; level < height; ++level)
+    {
+      for (std::size_t g = 0; g < count; ++g)
+      {
+        if (k[g] <= node_count)
+        {
+          const std::size_t right = lo[k[g]] <= x[g];
+          candidate[g] += (k[g] - candidate[g]) * right;
+          k[g] = 2 * k[g] + right;
+          prefetch(lo + std::min(k[g], node_count));
+        }
+      }
+    }
+    for (std::size_t g = 0; g < count; ++g)
+    {
+      finish(first + g, candidate[g]);
+    }
+  }
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_INTERLEAVED_SEARCH_HPP
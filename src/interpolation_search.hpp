@@ -0,0 +1,203 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Searches of a sorted array of bounds that guess where a scalar lies from
+ * the values of the bounds rather than halving the array blindly. When the
+ * bounds are roughly evenly spread, interpolation search takes
+ * O(log log n) probes instead of O(log n). Both searches watch their own
+ * progress and finish with a binary search once the guesses stop paying off,
+ * so that skewed tables cost little more than a plain binary search.
+ */
+
+#ifndef NUMERIC_RANGE_INTERPOLATION_SEARCH_HPP
+#define NUMERIC_RANGE_INTERPOLATION_SEARCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+namespace numeric_range {
+
+/**
+ * How a static index searches its sorted lower bounds. All strategies find
+ * the same range; they only differ in speed.
+ */
+enum class SearchStrategy
+{
+  binary,                   ///< Branch-free binary search
+  interpolation,            ///< Interpolation search, binary once it stalls
+  interpolation_sequential  ///< One interpolation probe, then a short scan
+};
+
+namespace detail {
+
+// Probes that fail to halve the interval before interpolation gives up
+constexpr unsigned max_bad_probes = 4;
+
+// Elements scanned after the probe of interpolation-sequential search
+// before it gives up, a few cache lines for 8 byte bounds
+constexpr std::size_t max_sequential_scan = 32;
+
+/**
+ * Branch-free binary search of a[lo, hi), which must not be empty.
+ * @return Last position in [lo, hi) holding a value <= x, or lo
+ */
+template<typename T>
+std::size_t
+last_le (const T *a, std::size_t lo, std::size_t hi, const T x)
+{
+  std::size_t base = lo;
+  std::size_t n = hi - lo;
+  while (n > 1)
+  {
+    const std::size_t half = n / 2;
+    base = a[base + half] <= x ? base + half : base;
+    n -= half;
+  }
+  return base;
+}
+
+/**
+ * Position strictly between lo and hi at which x would lie if the values of
+ * a[lo, hi] were evenly spread. Requires hi - lo >= 2 and
+ * a[lo] <= x < a[hi].
+ */
+template<typename T>
+std::size_t
+interpolate (const T *a, std::size_t lo, std::size_t hi, const T x)
+{
+  const double width = double(hi - lo);
+  double pos = (double(x) - double(a[lo])) / (double(a[hi]) - double(a[lo]))
+               * width;
+  // Infinite bounds, or bounds that round to the same double, give NaN or
+  // the ends of the interval
+  pos = pos >= 1 ? pos : 1;
+  pos = pos <= width - 1 ? pos : width - 1;
+  return lo + std::size_t(pos);
+}
+
+/**
+ * Interpolation search of a sorted array, which falls back to a binary
+ * search of the remaining interval after max_bad_probes probes that left
+ * more than half of it.
+ * @param a Sorted array of size > 0 elements
+ * @param size
+ * @param x
+ * @return Last position holding a value <= x, or 0 if there is none
+ */
+template<typename T>
+std::size_t
+interpolation_search (const T *a, std::size_t size, const T x)
+{
+  std::size_t lo = 0;
+  std::size_t hi = size - 1;
+  // Also sends NaN to the first position, where it cannot match
+  if (!(a[lo] <= x))
+  {
+    return 0;
+  }
+  if (a[hi] <= x)
+  {
+    return hi;
+  }
+  // From here on, a[lo] <= x < a[hi]
+  unsigned bad_probes = 0;
+  while (hi - lo > 1)
+  {
+    if (bad_probes == max_bad_probes)
+    {
+      return last_le(a, lo, hi, x);
+    }
+    const std::size_t width = hi - lo;
+    const std::size_t mid = interpolate(a, lo, hi, x);
+    if (a[mid] <= x)
+    {
+      lo = mid;
+    }
+    else
+    {
+      hi = mid;
+    }
+    bad_probes += 2 * (hi - lo) > width;
+  }
+  return lo;
+}
+
+/**
+ * Interpolation-sequential search of a sorted array: a single interpolation
+ * probe over the whole array, then a linear scan towards x, which falls
+ * back to a binary search of the rest of the array after
+ * max_sequential_scan elements.
+ * @param a Sorted array of size > 0 elements
+ * @param size
+ * @param x
+ * @return Last position holding a value <= x, or 0 if there is none
+ */
+template<typename T>
+std::size_t
+interpolation_sequential_search (const T *a, std::size_t size, const T x)
+{
+  const std::size_t last = size - 1;
+  if (!(a[0] <= x))
+  {
+    return 0;
+  }
+  if (a[last] <= x)
+  {
+    return last;
+  }
+  if (last == 1)
+  {
+    return 0;
+  }
+  std::size_t pos = interpolate(a, 0, last, x);
+  if (a[pos] <= x)
+  {
+    // a[last] > x ends the scan
+    const std::size_t stop = std::min(pos + max_sequential_scan, last);
+    while (pos < stop && a[pos + 1] <= x)
+    {
+      ++pos;
+    }
+    return pos == stop ? last_le(a, stop, last, x) : pos;
+  }
+  // a[0] <= x ends the scan
+  const std::size_t stop = pos > max_sequential_scan
+                           ? pos - max_sequential_scan : 0;
+  while (pos > stop && !(a[pos] <= x))
+  {
+    --pos;
+  }
+  return a[pos] <= x ? pos : last_le(a, 0, stop, x);
+}
+
+/**
+ * @param a Sorted array of size > 0 elements
+ * @param size
+ * @param x
+ * @param strategy
+ * @return Last position holding a value <= x, or 0 if there is none
+ */
+template<typename T>
+std::size_t
+search_sorted (const T *a, std::size_t size, const T x,
+               SearchStrategy strategy)
+{
+  switch (strategy)
+  {
+    case SearchStrategy::interpolation:
+      return interpolation_search(a, size, x);
+    case SearchStrategy::interpolation_sequential:
+      return interpolation_sequential_search(a, size, x);
+    default:
+      return last_le(a, 0, size, x);
+  }
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_INTERPOLATION_SEARCH_HPP
@@ -0,0 +1,316 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A static centered interval tree over NumericRange objects that, unlike the
+ * other containers in this library, may overlap each other. It answers
+ * stabbing ("which ranges contain x") and overlap queries.
+ */
+
+#ifndef NUMERIC_RANGE_INTERVAL_TREE_HPP
+#define NUMERIC_RANGE_INTERVAL_TREE_HPP
+
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A centered interval tree built in bulk from arbitrary, possibly
+ * overlapping ranges. Each node stores a center point and the ranges that
+ * contain it, sorted once by lower bound and once by upper bound, so a
+ * stabbing query visits O(log n) nodes and only scans ranges it reports.
+ * Query results are positions in the sequence the tree was built from,
+ * reported in no particular order.
+ * Bounds are compared in their closed form (see detail::closed_lb and
+ * detail::closed_ub), so inclusive/exclusive bounds have the same meaning as
+ * in NumericRangeComparator.
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+class IntervalTree
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "IntervalTree requires an arithmetic type");
+
+public:
+  IntervalTree () = default;
+
+  /**
+   * Build the tree from any sequence of NumericRange<T> in O(n log n).
+   * @param first
+   * @param last
+   */
+  template<typename InputIt>
+  IntervalTree (InputIt first, InputIt last) :
+      ranges_(first, last)
+  {
+    build();
+  }
+
+  explicit IntervalTree (const std::vector<NumericRange<T> > &ranges) :
+      ranges_(ranges)
+  {
+    build();
+  }
+
+  /**
+   * Call f(position) for every range containing the scalar x, in
+   * O(log n + k) for k results.
+   * @param x
+   * @param f Callable taking a std::size_t
+   */
+  template<typename F>
+  void
+  for_each_containing (const T x, F &&f) const
+  {
+    if (!(x == x))
+    {
+      return;
+    }
+    std::size_t node = root_;
+    while (node != none)
+    {
+      const Node &cur = nodes_[node];
+      if (x < cur.center)
+      {
+        for (std::size_t i = cur.begin; i < cur.end && by_lo_[i].bound <= x; ++i)
+        {
+          f(by_lo_[i].pos);
+        }
+        node = cur.left;
+      }
+      else if (cur.center < x)
+      {
+        for (std::size_t i = cur.begin; i < cur.end && x <= by_hi_[i].bound; ++i)
+        {
+          f(by_hi_[i].pos);
+        }
+        node = cur.right;
+      }
+      else
+      {
+        for (std::size_t i = cur.begin; i < cur.end; ++i)
+        {
+          f(by_lo_[i].pos);
+        }
+        node = none;
+      }
+    }
+  }
+
+  /**
+   * Call f(position) for every range sharing at least one value with query,
+   * in O(log n + k) for k results.
+   * @param query
+   * @param f Callable taking a std::size_t
+   */
+  template<typename F>
+  void
+  for_each_overlapping (const NumericRange<T> &query, F &&f) const
+  {
+    const T a = detail::closed_lb(query);
+    const T b = detail::closed_ub(query);
+    if (!(a <= b))
+    {
+      return;
+    }
+    // Every overlapping range either contains a, or starts after a but no
+    // later than b. The two groups are disjoint.
+    for_each_containing(a, f);
+    auto it = std::upper_bound(
+        starts_.begin(), starts_.end(), a,
+        [] (const T &value, const Bound &bound) { return value < bound.bound; });
+    for (; it != starts_.end() && it->bound <= b; ++it)
+    {
+      f(it->pos);
+    }
+  }
+
+  /**
+   * @param x
+   * @return Positions of all ranges containing x
+   */
+  std::vector<std::size_t>
+  containing (const T x) const
+  {
+    std::vector<std::size_t> result;
+    for_each_containing(x, [&result] (std::size_t pos) {
+      result.push_back(pos);
+    });
+    return result;
+  }
+
+  /**
+   * @param query
+   * @return Positions of all ranges overlapping query
+   */
+  std::vector<std::size_t>
+  overlapping (const NumericRange<T> &query) const
+  {
+    std::vector<std::size_t> result;
+    for_each_overlapping(query, [&result] (std::size_t pos) {
+      result.push_back(pos);
+    });
+    return result;
+  }
+
+  /**
+   * @param pos
+   * @return The range at position pos of the input sequence
+   */
+  const NumericRange<T> &range (std::size_t pos) const { return ranges_[pos]; }
+
+  std::size_t size () const { return ranges_.size(); }
+  bool empty () const { return ranges_.empty(); }
+
+private:
+  static constexpr std::size_t none = ~std::size_t(0);
+
+  struct Bound
+  {
+    T bound;
+    std::size_t pos;
+  };
+
+  struct Node
+  {
+    T center;
+    std::size_t left;
+    std::size_t right;
+    // Slice of by_lo_ and by_hi_ holding the ranges that contain center
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  std::vector<NumericRange<T> > ranges_;
+  std::vector<Node> nodes_;
+  std::size_t root_ = none;
+  // Per node: closed lower bounds ascending, closed upper bounds descending
+  std::vector<Bound> by_lo_;
+  std::vector<Bound> by_hi_;
+  // All closed lower bounds in ascending order
+  std::vector<Bound> starts_;
+
+  void
+  build ()
+  {
+    std::vector<Bound> lo;
+    std::vector<Bound> hi;
+    for (std::size_t i = 0; i < ranges_.size(); ++i)
+    {
+      const T a = detail::closed_lb(ranges_[i]);
+      const T b = detail::closed_ub(ranges_[i]);
+      // Ranges such as (1, 2) over integers contain no values at all
+      if (a <= b)
+      {
+        lo.push_back({a, i});
+        hi.push_back({b, i});
+      }
+    }
+    const auto by_bound = [] (const Bound &l, const Bound &r) {
+      return l.bound < r.bound;
+    };
+    std::sort(lo.begin(), lo.end(), by_bound);
+    std::sort(hi.begin(), hi.end(), by_bound);
+    starts_ = lo;
+
+    std::vector<T> lo_of(ranges_.size());
+    std::vector<T> hi_of(ranges_.size());
+    for (std::size_t i = 0; i < lo.size(); ++i)
+    {
+      lo_of[lo[i].pos] = lo[i].bound;
+      hi_of[hi[i].pos] = hi[i].bound;
+    }
+
+    by_lo_.reserve(lo.size());
+    by_hi_.reserve(lo.size());
+    root_ = build_node(lo, hi, lo_of, hi_of);
+  }
+
+  /**
+   * Build the subtree for the ranges in lo (sorted by closed LB) and hi (the
+   * same ranges sorted by closed UB). The center is the median of all
+   * endpoints, so each child receives at most half of the ranges.
+   */
+  std::size_t
+  build_node (const std::vector<Bound> &lo, const std::vector<Bound> &hi,
+              const std::vector<T> &lo_of, const std::vector<T> &hi_of)
+  {
+    if (lo.empty())
+    {
+      return none;
+    }
+
+    const std::size_t m = lo.size();
+    // Merge-select the m-th smallest of the 2m endpoints
+    std::size_t i = 0;
+    std::size_t j = 0;
+    T center = lo[0].bound;
+    for (std::size_t taken = 0; taken < m; ++taken)
+    {
+      if (j == m || (i < m && !(hi[j].bound < lo[i].bound)))
+      {
+        center = lo[i++].bound;
+      }
+      else
+      {
+        center = hi[j++].bound;
+      }
+    }
+
+    std::vector<Bound> left_lo, left_hi, right_lo, right_hi;
+    const std::size_t begin = by_lo_.size();
+    for (const Bound &b : lo)
+    {
+      if (hi_of[b.pos] < center)
+      {
+        left_lo.push_back(b);
+      }
+      else if (center < b.bound)
+      {
+        right_lo.push_back(b);
+      }
+      else
+      {
+        by_lo_.push_back(b);
+      }
+    }
+    for (auto it = hi.rbegin(); it != hi.rend(); ++it)
+    {
+      if (it->bound < center)
+      {
+        left_hi.push_back(*it);
+      }
+      else if (center < lo_of[it->pos])
+      {
+        right_hi.push_back(*it);
+      }
+      else
+      {
+        by_hi_.push_back(*it);
+      }
+    }
+    std::reverse(left_hi.begin(), left_hi.end());
+    std::reverse(right_hi.begin(), right_hi.end());
+
+    const std::size_t node = nodes_.size();
+    nodes_.push_back({center, none, none, begin, by_lo_.size()});
+    const std::size_t left = build_node(left_lo, left_hi, lo_of, hi_of);
+    const std::size_t right = build_node(right_lo, right_hi, lo_of, hi_of);
+    nodes_[node].left = left;
+    nodes_[node].right = right;
+    return node;
+  }
+}; /* class IntervalTree */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_INTERVAL_TREE_HPP
@@ -0,0 +1,412 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A static index for address ranges, such as IPv4 (std::uint32_t) and IPv6
+ * (uint128_t) ranges mapped to metadata. A multibit trie, derived from the
+ * lower bounds of the ranges, consumes several bits of an address per node
+ * and ends in short runs of lower bounds, so that a lookup costs a few node
+ * visits however wide the keys are, rather than a comparison of wide keys
+ * at every step of a binary search.
+ */
+
+#ifndef NUMERIC_RANGE_IP_INDEX_HPP
+#define NUMERIC_RANGE_IP_INDEX_HPP
+
+#include "cache_utils.hpp"
+#include "interleaved_search.hpp"
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * An immutable index answering "which range contains x" for sorted,
+ * non-overlapping ranges of an unsigned integral type, with the same
+ * semantics as NumericRangeComparator. Bounds are stored in closed
+ * canonical form (see detail::closed_lb and detail::closed_ub).
+ * Every node of the trie covers an aligned window of keys, holds the lower
+ * bounds that fall in it, and splits it into 2^stride equal slots. Its
+ * stride grows with the number of bounds it holds, and the leading bits
+ * shared by all of them are skipped, so that sparse and clustered address
+ * plans both stay shallow. A slot with at most leaf_run bounds is a leaf
+ * that points at them, and a lookup ends by counting the bounds <= x in
+ * one leaf and checking the upper bound of the last of them.
+ * @tparam T An unsigned integral type, typically std::uint32_t for IPv4 or
+ * uint128_t for IPv6.
+ */
+template<typename T>
+class IpRangeIndex
+{
+  static_assert(detail::is_integer<T>::value && T(0) < T(-1)
+                && !std::is_same<T, bool>::value,
+                "IpRangeIndex requires an unsigned integral type");
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  /// Largest number of lower bounds in a leaf, which are scanned linearly.
+  static constexpr std::size_t leaf_run = 8;
+
+  /// Largest stride of the root, whose table can hold up to 4 MiB.
+  static constexpr unsigned max_root_stride = 20;
+
+  /// Largest stride of the other nodes.
+  static constexpr unsigned max_stride = 16;
+
+  IpRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass.
+   * @param first
+   * @param last
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has 2^27 or more elements
+   */
+  template<typename InputIt>
+  IpRangeIndex (InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit IpRangeIndex (const std::vector<NumericRange<T> > &sorted) :
+      IpRangeIndex(sorted.begin(), sorted.end())
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same semantics as
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    if (ub_.empty())
+    {
+      return npos;
+    }
+    index_type entry = root_;
+    while (entry & node_bit)
+    {
+      entry = step(x, entry);
+    }
+    return finish(x, entry);
+  }
+
+  /**
+   * Look up many scalars at once in a table much larger than the cache.
+   * group searches descend the trie in lock-step, each prefetching the node
+   * or the leaf it visits next, so that their memory accesses overlap.
+   * Equivalent to calling find() for every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   * @param group Number of searches in flight, at most 64
+   */
+  void
+  lookup_interleaved (const T *keys, std::size_t n, index_type *out,
+                      std::size_t group = detail::default_lookup_group) const
+  {
+    if (ub_.empty())
+    {
+      std::fill(out, out + n, npos);
+      return;
+    }
+    group = std::min(std::max<std::size_t>(group, 1),
+                     detail::max_lookup_group);
+    index_type entry[detail::max_lookup_group];
+    for (std::size_t first = 0; first < n; first += group)
+    {
+      const std::size_t count = std::min(group, n - first);
+      const T *x = keys + first;
+      std::fill(entry, entry + count, root_);
+      for (unsigned level = 0; level < depth_; ++level)
+      {
+        for (std::size_t g = 0; g < count; ++g)
+        {
+          if (entry[g] & node_bit)
+          {
+            entry[g] = step(x[g], entry[g]);
+            prefetch_entry(entry[g]);
+          }
+        }
+      }
+      for (std::size_t g = 0; g < count; ++g)
+      {
+        out[first + g] = finish(x[g], entry[g]);
+      }
+    }
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  std::size_t size () const { return ub_.size(); }
+  bool empty () const { return ub_.empty(); }
+
+  /**
+   * @return Number of nodes of the trie
+   */
+  std::size_t node_count () const { return node_count_; }
+
+  /**
+   * @return Number of nodes on the longest path from the root to a leaf
+   */
+  unsigned depth () const { return depth_; }
+
+  /**
+   * @return Bytes taken by the trie, excluding the bounds themselves
+   */
+  std::size_t
+  trie_size () const
+  {
+    return trie_.size() * sizeof(index_type);
+  }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity()) * sizeof(T)
+           + trie_.capacity() * sizeof(index_type);
+  }
+
+private:
+  static constexpr unsigned key_bits = sizeof(T) * CHAR_BIT;
+
+  // An entry is either a node, flagged by node_bit, or a leaf holding the
+  // position of its first lower bound and, above len_shift, their number
+  static constexpr index_type node_bit = index_type(1) << 31;
+  static constexpr unsigned len_shift = 27;
+  static constexpr index_type begin_mask = (index_type(1) << len_shift) - 1;
+
+  // Average number of lower bounds per slot aimed for
+  static constexpr std::size_t target_run = leaf_run / 2;
+
+  // A node is laid out in trie_ as a header followed by its 2^stride
+  // entries, so that the header and the first entries share a cache line.
+  // The header holds the first key of the window of the node, the shift that
+  // selects a slot within it, the number of slots, and the lower bounds of
+  // the window, lb_[begin, end).
+  static constexpr std::size_t lo_words =
+      (sizeof(T) + sizeof(index_type) - 1) / sizeof(index_type);
+  static constexpr std::size_t shift_word = 0;
+  static constexpr std::size_t slots_word = 1;
+  static constexpr std::size_t begin_word = 2;
+  static constexpr std::size_t end_word = 3;
+  static constexpr std::size_t header_words = lo_words + 4;
+
+  detail::aligned_vector<T> lb_;
+  detail::aligned_vector<T> ub_;
+  detail::aligned_vector<index_type> trie_;
+  index_type root_ = 0;
+  std::size_t node_count_ = 0;
+  unsigned depth_ = 0;
+
+  /**
+   * @param x
+   * @param le Number of lower bounds <= x
+   */
+  index_type
+  resolve (const T x, std::size_t le) const
+  {
+    return le != 0 && x <= ub_[le - 1] ? index_type(le - 1) : npos;
+  }
+
+  /**
+   * Descend from a node to the entry of the slot of x. When x lies before
+   * or after all of the bounds of the node, this is an empty leaf at the
+   * position of the first bound after x.
+   */
+  index_type
+  step (const T x, const index_type entry) const
+  {
+    const index_type *node = trie_.data() + (entry & ~node_bit);
+    T lo;
+    std::memcpy(&lo, node, sizeof(T));
+    const T slot = T(T(x - lo) >> node[lo_words + shift_word]);
+    // Outside of the window of the node, x - lo either wraps around or
+    // exceeds the last slot
+    if (slot >= node[lo_words + slots_word])
+    {
+      return x < lo ? node[lo_words + begin_word] : node[lo_words + end_word];
+    }
+    return node[header_words + std::size_t(slot)];
+  }
+
+  /**
+   * Count the lower bounds <= x in a leaf and check the last of them.
+   */
+  index_type
+  finish (const T x, const index_type entry) const
+  {
+    const std::size_t begin = entry & begin_mask;
+    const std::size_t len = entry >> len_shift;
+    // The upper bound checked last is one of the leaf's, so it is fetched
+    // while the lower bounds are counted
+    detail::prefetch(ub_.data() + begin + len / 2);
+    const T *lb = lb_.data() + begin;
+    std::size_t le = begin;
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      le += lb[i] <= x;
+    }
+    return resolve(x, le);
+  }
+
+  void
+  prefetch_entry (const index_type entry) const
+  {
+    if (entry & node_bit)
+    {
+      detail::prefetch(trie_.data() + (entry & ~node_bit));
+    }
+    else
+    {
+      const std::size_t begin = entry & begin_mask;
+      detail::prefetch(lb_.data() + begin);
+      detail::prefetch(ub_.data() + begin + (entry >> len_shift) / 2);
+    }
+  }
+
+  static unsigned
+  bit_width (T v)
+  {
+    unsigned width = 0;
+    for (; v != 0; v >>= 1)
+    {
+      ++width;
+    }
+    return width;
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n > begin_mask)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for IpRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+
+    lb_.reserve(n);
+    ub_.reserve(n);
+    for (; first != last; ++first)
+    {
+      // Closed lower bounds never decrease, even around empty ranges
+      lb_.push_back(detail::closed_lb(*first));
+      ub_.push_back(detail::closed_ub(*first));
+    }
+    if (n != 0)
+    {
+      root_ = make_entry(0, n, 0);
+    }
+    if (trie_.size() > node_bit)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many trie nodes for IpRangeIndex"));
+    }
+  }
+
+  /**
+   * Build the subtree for the lower bounds lb_[begin, end), which all fall
+   * in the window of one slot.
+   * @param depth Number of nodes above the subtree
+   * @return Entry referring to the subtree
+   */
+  index_type
+  make_entry (std::size_t begin, std::size_t end, unsigned depth)
+  {
+    const std::size_t count = end - begin;
+    if (count <= leaf_run)
+    {
+      return index_type(begin | count << len_shift);
+    }
+    // At most two closed lower bounds are equal, around an empty range, so
+    // the first and the last differ
+    const unsigned top = bit_width(lb_[begin] ^ lb_[end - 1]);
+    const T low_bits = top == key_bits ? T(-1) : T((T(1) << top) - 1);
+    const T lo = lb_[begin] & T(~low_bits);
+    const unsigned cap = depth == 0 ? max_root_stride : max_stride;
+    const unsigned stride = std::min(
+        std::max(bit_width(T((count - 1) / target_run)), 1u),
+        std::min(top, cap));
+    const unsigned shift = top - stride;
+    const std::size_t slots = std::size_t(1) << stride;
+
+    const std::size_t node = trie_.size();
+    trie_.resize(node + header_words + slots);
+    std::memcpy(trie_.data() + node, &lo, sizeof(T));
+    trie_[node + lo_words + shift_word] = index_type(shift);
+    trie_[node + lo_words + slots_word] = index_type(slots);
+    trie_[node + lo_words + begin_word] = index_type(begin);
+    trie_[node + lo_words + end_word] = index_type(end);
+    ++node_count_;
+    depth_ = std::max(depth_, depth + 1);
+
+    std::size_t pos = begin;
+    for (std::size_t slot = 0; slot < slots; ++slot)
+    {
+      // Last key of the slot, computed so that the last slot ends with the
+      // window without overflowing
+      const T slot_hi = T(lo + (T(slot) << shift) + ((T(1) << shift) - 1));
+      std::size_t slot_end = pos;
+      while (slot_end < end && lb_[slot_end] <= slot_hi)
+      {
+        ++slot_end;
+      }
+      // Subtrees append to trie_, so the slot is written afterwards
+      const index_type entry = make_entry(pos, slot_end, depth + 1);
+      trie_[node + header_words + slot] = entry;
+      pos = slot_end;
+    }
+    return index_type(node) | node_bit;
+  }
+}; /* class IpRangeIndex */
+
+/// Ranges of IPv4 addresses.
+using Ipv4RangeIndex = IpRangeIndex<std::uint32_t>;
+
+#ifdef NUMERIC_RANGE_HAS_INT128
+/// Ranges of IPv6 addresses.
+using Ipv6RangeIndex = IpRangeIndex<uint128_t>;
+#endif
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_IP_INDEX_HPP
@@ -0,0 +1,282 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A static learned index over sorted, non-overlapping ranges. A piecewise
+ * linear model of position against lower bound predicts where a scalar lies
+ * to within a fixed error, which leaves a short search in place of a binary
+ * search over the whole table.
+ */
+
+#ifndef NUMERIC_RANGE_LEARNED_INDEX_HPP
+#define NUMERIC_RANGE_LEARNED_INDEX_HPP
+
+#include "cache_utils.hpp"
+#include "interpolation_search.hpp"
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * An immutable index answering "which range contains x" for sorted,
+ * non-overlapping ranges of an arithmetic type. Ranges are stored in closed
+ * canonical form (see detail::closed_lb and detail::closed_ub), so the
+ * final containment check is two <= comparisons with the same meaning as
+ * NumericRangeComparator, and NaN never matches.
+ * The closed lower bounds are split into segments, each with a line that
+ * predicts the position of every bound in it to within max_error. A lookup
+ * is a binary search over the first bound of each segment, one
+ * multiply-add, and a binary search over the 2 * max_error + 3 positions
+ * around the prediction. Predictions are checked against the bounds at the
+ * edges of that window, so rounding can cost a full search but never a
+ * wrong result.
+ * The model is small when bounds are evenly spread within long stretches,
+ * and degrades towards one segment per max_error ranges otherwise.
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+class LearnedRangeIndex
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "LearnedRangeIndex requires an arithmetic type");
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  /// Default bound on the distance between predicted and actual positions.
+  static constexpr std::size_t default_max_error = 32;
+
+  LearnedRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass.
+   * @param first
+   * @param last
+   * @param max_error Largest distance between the predicted and the actual
+   * position of a lower bound
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has npos or more elements
+   */
+  template<typename InputIt>
+  LearnedRangeIndex (InputIt first, InputIt last,
+                     std::size_t max_error = default_max_error) :
+      max_error_(max_error)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit LearnedRangeIndex (const std::vector<NumericRange<T> > &sorted,
+                              std::size_t max_error = default_max_error) :
+      LearnedRangeIndex(sorted.begin(), sorted.end(), max_error)
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same semantics as
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    const std::size_t size = lb_.size();
+    if (size == 0)
+    {
+      return npos;
+    }
+    const std::size_t s =
+        detail::last_le(seg_lb_.data(), 0, seg_lb_.size(), x);
+    const std::size_t first = segments_[s].first;
+    const std::size_t last = s + 1 < segments_.size()
+                             ? segments_[s + 1].first : size;
+
+    // Position predicted by the line, clamped to the segment. NaN and
+    // values before the segment end up at its first position.
+    double offset = segments_[s].slope * (double(x) - double(seg_lb_[s]));
+    const double span = double(last - 1 - first);
+    offset = offset > 0 ? offset : 0;
+    offset = offset < span ? offset : span;
+    const std::size_t predicted = first + std::size_t(offset);
+
+    // The answer lies within max_error + 1 of the prediction
+    const std::size_t reach = max_error_ + 1;
+    std::size_t lo = predicted > reach ? predicted - reach : 0;
+    std::size_t hi = std::min(predicted + reach + 1, size);
+    const T *lb = lb_.data();
+    if (!((lo == 0 || lb[lo] <= x) && (hi == size || !(lb[hi] <= x))))
+    {
+      lo = 0;
+      hi = size;
+    }
+    return resolve(x, detail::last_le(lb, lo, hi, x));
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  std::size_t size () const { return lb_.size(); }
+  bool empty () const { return lb_.empty(); }
+
+  std::size_t max_error () const { return max_error_; }
+
+  /**
+   * @return Number of linear segments in the model
+   */
+  std::size_t segment_count () const { return segments_.size(); }
+
+  /**
+   * @return Bytes taken by the model, excluding the bounds themselves
+   */
+  std::size_t
+  model_size () const
+  {
+    return segments_.size() * (sizeof(T) + sizeof(Segment));
+  }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity() + seg_lb_.capacity()) * sizeof(T)
+           + segments_.capacity() * sizeof(Segment);
+  }
+
+private:
+  struct Segment
+  {
+    double slope;
+    index_type first;
+  };
+
+  std::size_t max_error_ = default_max_error;
+  detail::aligned_vector<T> lb_;
+  detail::aligned_vector<T> ub_;
+  // First closed lower bound of each segment
+  detail::aligned_vector<T> seg_lb_;
+  std::vector<Segment> segments_;
+
+  /**
+   * @param x
+   * @param base Last position with a lower bound <= x, or 0
+   */
+  index_type
+  resolve (const T x, std::size_t base) const
+  {
+    return (lb_[base] <= x) & (x <= ub_[base]) ? index_type(base) : npos;
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n >= npos)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for LearnedRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+
+    lb_.reserve(n);
+    ub_.reserve(n);
+    for (; first != last; ++first)
+    {
+      // Closed lower bounds never decrease, even around empty ranges
+      lb_.push_back(detail::closed_lb(*first));
+      ub_.push_back(detail::closed_ub(*first));
+    }
+    fit();
+  }
+
+  /**
+   * Greedy fit of the segments: every segment starts at a bound and keeps
+   * the range of slopes that predict all of its bounds within max_error,
+   * and a bound that leaves no slope starts the next segment.
+   */
+  void
+  fit ()
+  {
+    const double error = double(max_error_);
+    const double inf = std::numeric_limits<double>::infinity();
+    double slope_lo = 0;
+    double slope_hi = inf;
+    for (std::size_t i = 0; i < lb_.size(); ++i)
+    {
+      if (!segments_.empty())
+      {
+        const Segment &seg = segments_.back();
+        const double dx = double(lb_[i]) - double(seg_lb_.back());
+        const double dy = double(i - seg.first);
+        double lo = slope_lo;
+        double hi = slope_hi;
+        if (dx > 0)
+        {
+          lo = std::max(lo, (dy - error) / dx);
+          hi = std::min(hi, (dy + error) / dx);
+        }
+        else if (dy > error)
+        {
+          // Equal bounds, which only empty ranges can produce
+          lo = inf;
+        }
+        if (lo <= hi)
+        {
+          slope_lo = lo;
+          slope_hi = hi;
+          continue;
+        }
+        finish_segment(slope_lo, slope_hi);
+      }
+      seg_lb_.push_back(lb_[i]);
+      segments_.push_back({0, index_type(i)});
+      slope_lo = 0;
+      slope_hi = inf;
+    }
+    if (!segments_.empty())
+    {
+      finish_segment(slope_lo, slope_hi);
+    }
+  }
+
+  void
+  finish_segment (double slope_lo, double slope_hi)
+  {
+    // A single bound constrains no slope
+    segments_.back().slope = slope_hi == std::numeric_limits<double>::infinity()
+                             ? 0 : (slope_lo + slope_hi) / 2;
+  }
+}; /* class LearnedRangeIndex */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_LEARNED_INDEX_HPP
@@ -16,16 +16,76 @@
 #ifndef NUMERIC_RANGE_HPP
 #define NUMERIC_RANGE_HPP
 
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define NUMERIC_RANGE_THROW(exception) throw exception
+#else
+#include <cstdlib>
+// Builds without exception support abort where an exception would be thrown.
+// Use the non-throwing APIs (e.g. NumericRangeComparator::compare,
+// NumericRange::is_valid, RangeMap::try_insert) to avoid this.
+#define NUMERIC_RANGE_THROW(exception) std::abort()
+#endif
+
+#if defined(__SIZEOF_INT128__)
+#define NUMERIC_RANGE_HAS_INT128 1
+#endif
 
 namespace numeric_range {
 
+#ifdef NUMERIC_RANGE_HAS_INT128
+// 128-bit integers of GCC and Clang, e.g. for IPv6 addresses. __extension__
+// keeps pedantic builds quiet about them.
+__extension__ typedef __int128 int128_t;
+__extension__ typedef unsigned __int128 uint128_t;
+#endif
+
+namespace detail {
+
+/**
+ * std::is_integral, extended to int128_t and uint128_t, which the standard
+ * library only counts as integral outside of strict ISO modes.
+ */
+template<typename T>
+struct is_integer : std::is_integral<T>
+{};
+
+#ifdef NUMERIC_RANGE_HAS_INT128
+template<>
+struct is_integer<int128_t> : std::true_type
+{};
+
+template<>
+struct is_integer<uint128_t> : std::true_type
+{};
+#endif
+
+/**
+ * std::is_arithmetic, extended to int128_t and uint128_t.
+ */
+template<typename T>
+struct is_arithmetic
+    : std::integral_constant<bool, is_integer<T>::value
+                                   || std::is_floating_point<T>::value>
+{};
+
+} /* namespace detail */
+
 /**
  * A Numeric Range represents a linear space with a minimum and maximum bound.
  * While the class is templated for any type T, as the name suggests, this
  * should be used for numeric types only. Other types may have undefined
  * behavior.
  * Use the NumericRangeComparator to compare NumericRange objects.
+ * Besides the standard arithmetic types, int128_t and uint128_t are
+ * supported where the compiler provides them (NUMERIC_RANGE_HAS_INT128).
  * @tparam T Recommend a numeric type that has a well-defined operator<.
  */
 template<typename T>
@@ -57,11 +117,12 @@ public:
   {
     if (lb > ub)
     {
-      throw std::runtime_error("LB cannot be greater than UB");
+      NUMERIC_RANGE_THROW(std::runtime_error("LB cannot be greater than UB"));
     }
     if (lb == ub && (!lb_inclusive || !ub_inclusive))
     {
-      throw std::runtime_error("LB and UB must be inclusive when LB == UB");
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "LB and UB must be inclusive when LB == UB"));
     }
   }
 
@@ -76,8 +137,48 @@ public:
       lb(_scalar), lb_inclusive(true),
       ub(_scalar), ub_inclusive(true)
   {}
+
+  /**
+   * Check the constraints enforced by the bounds constructor without
+   * constructing (and possibly throwing).
+   * @param _lb
+   * @param _lb_inclusive
+   * @param _ub
+   * @param _ub_inclusive
+   * @return Whether a NumericRange with these bounds would be valid
+   */
+  static bool
+  is_valid (const T _lb, const bool _lb_inclusive,
+            const T _ub, const bool _ub_inclusive) noexcept
+  {
+    return !(_lb > _ub) && (_lb != _ub || (_lb_inclusive && _ub_inclusive));
+  }
 }; /* class NumericRange */
 
+/**
+ * The result of a three-way comparison of two NumericRange objects.
+ */
+enum class RangeOrdering
+{
+  less,       ///< LHS lies entirely before RHS
+  greater,    ///< LHS lies entirely after RHS
+  equal,      ///< Both are the same range (or the same scalar)
+  contains,   ///< RHS is a scalar contained in the range LHS
+  contained,  ///< LHS is a scalar contained in the range RHS
+  overlap     ///< Two ranges that overlap and hence cannot be ordered
+};
+
+/**
+ * The outcome of inserting a range into one of the containers of this
+ * library through a non-throwing insert method.
+ */
+enum class InsertStatus
+{
+  inserted,  ///< The range was inserted
+  exists,    ///< An equivalent range is already present; nothing changed
+  overlap    ///< The range overlaps a range already present; nothing changed
+};
+
 /**
  * This can be passed to STL containers or algorithms to aid in comparing
  * objects of type NumericRange.
@@ -87,6 +188,12 @@ template<typename T>
 class NumericRangeComparator
 {
 public:
+  /**
+   * Enables heterogeneous lookup, e.g. std::map::find(x) with a raw T
+   * instead of find(NumericRange<T>{x}).
+   */
+  using is_transparent = void;
+
   /**
    * Compare LHS and RHS of type NumericRange (their underlying template type
    * should also be the same) and return whether LHS < RHS.
@@ -102,48 +209,279 @@ public:
    */
   bool
   operator() (const NumericRange<T> &lhs, const NumericRange<T> &rhs) const
+  {
+    const RangeOrdering ordering = compare(lhs, rhs);
+    if (ordering == RangeOrdering::overlap)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Invalid comparison between overlapping ranges"));
+    }
+    return ordering == RangeOrdering::less;
+  } /* bool operator() */
+
+  /**
+   * Whether the range LHS lies entirely before the scalar RHS. Equivalent to
+   * operator()(lhs, NumericRange<T>{rhs}) without constructing the scalar
+   * range or checking whether it is one.
+   * @param lhs
+   * @param rhs
+   * @return Whether LHS < RHS
+   */
+  bool
+  operator() (const NumericRange<T> &lhs, const T &rhs) const noexcept
+  {
+    return (lhs.ub < rhs) || (lhs.ub == rhs && !lhs.ub_inclusive);
+  }
+
+  /**
+   * Whether the scalar LHS lies entirely before the range RHS. Equivalent to
+   * operator()(NumericRange<T>{lhs}, rhs).
+   * @param lhs
+   * @param rhs
+   * @return Whether LHS < RHS
+   */
+  bool
+  operator() (const T &lhs, const NumericRange<T> &rhs) const noexcept
+  {
+    return (lhs < rhs.lb) || (lhs == rhs.lb && !rhs.lb_inclusive);
+  }
+
+  /**
+   * Three-way comparison of LHS and RHS that never throws. Overlapping
+   * ranges are reported as RangeOrdering::overlap, and a scalar that falls
+   * within a range as RangeOrdering::contains or RangeOrdering::contained.
+   * operator() returns true exactly when this returns RangeOrdering::less.
+   * @param lhs
+   * @param rhs
+   * @return How LHS is ordered relative to RHS
+   */
+  RangeOrdering
+  compare (const NumericRange<T> &lhs, const NumericRange<T> &rhs) const
+  noexcept
   {
     const bool lhs_is_scalar = (lhs.lb == lhs.ub);
     const bool rhs_is_scalar = (rhs.lb == rhs.ub);
 
     if (lhs_is_scalar && rhs_is_scalar)
     {
-      return (lhs.lb < rhs.lb);
+      if (lhs.lb < rhs.lb)
+      {
+        return RangeOrdering::less;
+      }
+      return (rhs.lb < lhs.lb) ? RangeOrdering::greater : RangeOrdering::equal;
     }
     else if (lhs_is_scalar)
     {
-      return ((lhs.lb < rhs.lb) || (lhs.lb == rhs.lb && !rhs.lb_inclusive));
+      if ((lhs.lb < rhs.lb) || (lhs.lb == rhs.lb && !rhs.lb_inclusive))
+      {
+        return RangeOrdering::less;
+      }
+      else if ((rhs.ub < lhs.lb) || (rhs.ub == lhs.lb && !rhs.ub_inclusive))
+      {
+        return RangeOrdering::greater;
+      }
+      return RangeOrdering::contained;
     }
     else if (rhs_is_scalar)
     {
-      return ((lhs.ub < rhs.lb) || (lhs.ub == rhs.lb && !lhs.ub_inclusive));
+      if ((lhs.ub < rhs.lb) || (lhs.ub == rhs.lb && !lhs.ub_inclusive))
+      {
+        return RangeOrdering::less;
+      }
+      else if ((rhs.lb < lhs.lb) || (rhs.lb == lhs.lb && !lhs.lb_inclusive))
+      {
+        return RangeOrdering::greater;
+      }
+      return RangeOrdering::contains;
     }
     else
     {
       if (lhs.lb == rhs.lb && lhs.lb_inclusive == rhs.lb_inclusive
           && lhs.ub == rhs.ub && lhs.ub_inclusive == rhs.ub_inclusive)
       {
-        return false;
+        return RangeOrdering::equal;
       }
       else if ((lhs.ub < rhs.lb) ||
                (lhs.ub == rhs.lb && !(lhs.ub_inclusive && rhs.lb_inclusive)))
       {
-        return true;
+        return RangeOrdering::less;
       }
       else if ((lhs.lb > rhs.ub) ||
                (lhs.lb == rhs.ub && !(lhs.lb_inclusive && rhs.ub_inclusive)))
       {
-        return false;
+        return RangeOrdering::greater;
       }
       else
       {
-        throw std::runtime_error(
-            "Invalid comparison between overlapping ranges");
+        return RangeOrdering::overlap;
       }
     }
-  } /* bool operator() */
+  } /* RangeOrdering compare() */
 }; /* class NumericRangeComparator */
 
+/**
+ * Three-way comparison of two ranges that never throws.
+ * See NumericRangeComparator::compare.
+ */
+template<typename T>
+RangeOrdering
+compare (const NumericRange<T> &lhs, const NumericRange<T> &rhs) noexcept
+{
+  return NumericRangeComparator<T>().compare(lhs, rhs);
+}
+
+/**
+ * Tag selecting the bulk-load constructors of the containers in this
+ * library, which take input already sorted by NumericRangeComparator and
+ * validate it in a single linear pass instead of inserting one at a time.
+ */
+struct sorted_unique_t
+{
+  explicit sorted_unique_t () = default;
+};
+
+inline constexpr sorted_unique_t sorted_unique{};
+
+/**
+ * Find the first range in [first, last) that does not lie entirely after
+ * its predecessor, i.e. the first place where the sequence is unsorted,
+ * repeats a range or overlaps. Linear time and never throws.
+ * @param first
+ * @param last
+ * @return Iterator to the second range of the first offending adjacent
+ * pair, or last if the sequence is strictly sorted
+ */
+template<typename ForwardIt>
+ForwardIt
+disjoint_sorted_until (ForwardIt first, ForwardIt last) noexcept
+{
+  if (first == last)
+  {
+    return last;
+  }
+  ForwardIt prev = first;
+  for (ForwardIt it = std::next(first); it != last; prev = it, ++it)
+  {
+    if (compare(*prev, *it) != RangeOrdering::less)
+    {
+      return it;
+    }
+  }
+  return last;
+}
+
+namespace detail {
+
+/**
+ * Validate the input of a bulk-load constructor.
+ * @throws runtime_error Naming the positions of the first adjacent pair
+ * that is unsorted or overlaps
+ */
+template<typename ForwardIt>
+void
+check_disjoint_sorted (ForwardIt first, ForwardIt last)
+{
+  const ForwardIt it = disjoint_sorted_until(first, last);
+  if (it != last)
+  {
+    const std::size_t pos = std::size_t(std::distance(first, it));
+    NUMERIC_RANGE_THROW(std::runtime_error(
+        "Ranges must be sorted and must not overlap: positions "
+        + std::to_string(pos - 1) + " and " + std::to_string(pos)));
+  }
+}
+
+/**
+ * The smallest value of an arithmetic type T admitted by the lower bound of
+ * range, i.e. the lower bound of the equivalent closed range. A scalar x is
+ * then above the lower bound iff closed_lb(range) <= x, which is what
+ * NumericRangeComparator computes with its inclusive/exclusive checks.
+ * @param range
+ * @return LB if it is inclusive, otherwise the next representable value
+ */
+template<typename T>
+T
+closed_lb (const NumericRange<T> &range)
+{
+  static_assert(is_arithmetic<T>::value,
+                "closed_lb requires an arithmetic type");
+  if (range.lb_inclusive)
+  {
+    return range.lb;
+  }
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return std::nextafter(range.lb, std::numeric_limits<T>::infinity());
+  }
+  else
+  {
+    return T(range.lb + 1);
+  }
+}
+
+/**
+ * The largest value of an arithmetic type T admitted by the upper bound of
+ * range, i.e. the upper bound of the equivalent closed range.
+ * @param range
+ * @return UB if it is inclusive, otherwise the previous representable value
+ */
+template<typename T>
+T
+closed_ub (const NumericRange<T> &range)
+{
+  static_assert(is_arithmetic<T>::value,
+                "closed_ub requires an arithmetic type");
+  if (range.ub_inclusive)
+  {
+    return range.ub;
+  }
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    return std::nextafter(range.ub, -std::numeric_limits<T>::infinity());
+  }
+  else
+  {
+    return T(range.ub - 1);
+  }
+}
+
+/**
+ * Branch-free search of n sorted, non-overlapping ranges stored as columns,
+ * for the range containing the scalar x with the semantics of
+ * NumericRangeComparator: the last range whose lower bound admits x, then
+ * a check of its upper bound.
+ * @param lb Array of n lower bounds
+ * @param ub Array of n upper bounds
+ * @param n
+ * @param x
+ * @param lb_inclusive Called as lb_inclusive(pos)
+ * @param ub_inclusive Called as ub_inclusive(pos)
+ * @return Position of the containing range, or n
+ */
+template<typename T, typename LbInclusive, typename UbInclusive>
+std::size_t
+find_in_columns (const T *lb, const T *ub, std::size_t n, const T &x,
+                 LbInclusive &&lb_inclusive, UbInclusive &&ub_inclusive)
+{
+  if (n == 0)
+  {
+    return n;
+  }
+  const auto admits_lb = [&] (std::size_t pos) {
+    return (lb[pos] < x) || (lb[pos] == x && lb_inclusive(pos));
+  };
+  std::size_t base = 0;
+  for (std::size_t m = n; m > 1; m -= m / 2)
+  {
+    base = admits_lb(base + m / 2) ? base + m / 2 : base;
+  }
+  const bool below_ub = (x < ub[base])
+                        || (x == ub[base] && ub_inclusive(base));
+  return admits_lb(base) && below_ub ? base : n;
+}
+
+} /* namespace detail */
+
 } /* namespace numeric_range */
 
 #endif //NUMERIC_RANGE_HPP
@@ -0,0 +1,216 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Multi-threaded counterparts of sort_ranges and disjoint_sorted_until for
+ * large vectors of ranges, running on a ThreadPool.
+ */
+
+#ifndef NUMERIC_RANGE_PARALLEL_SORT_HPP
+#define NUMERIC_RANGE_PARALLEL_SORT_HPP
+
+#include "numeric_range.hpp"
+#include "range_sort.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+namespace detail {
+
+// Below this size splitting the work costs more than it saves.
+constexpr std::size_t parallel_cutoff = std::size_t(1) << 14;
+
+/**
+ * Merge path partitioning: the number of elements taken from left when the
+ * first d elements of the stable merge of left (n elements) and right (m
+ * elements) are produced. Lets disjoint slices of one merge run in
+ * parallel.
+ */
+template<typename Less>
+std::size_t
+merge_path_split (const RadixItem *left, std::size_t n,
+                  const RadixItem *right, std::size_t m, std::size_t d,
+                  Less less)
+{
+  std::size_t lo = d > m ? d - m : 0;
+  std::size_t hi = std::min(d, n);
+  while (lo < hi)
+  {
+    const std::size_t i = lo + (hi - lo) / 2;
+    // left[i] precedes right[d - i - 1] in the merge, so take more of left
+    if (!less(right[d - i - 1], left[i]))
+    {
+      lo = i + 1;
+    }
+    else
+    {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+} /* namespace detail */
+
+/**
+ * Sort ranges exactly as sort_ranges does, using every thread of pool. Each
+ * thread radix sorts a slice of the input, and the sorted slices are then
+ * merged pairwise, with every merge split across all threads by merge path
+ * partitioning. Since both steps are stable, the result is identical to
+ * that of sort_ranges.
+ * Small inputs, single-threaded pools and types without an order-preserving
+ * key are sorted with sort_ranges on the calling thread.
+ * @tparam T An arithmetic type.
+ * @param ranges
+ * @param pool
+ */
+template<typename T>
+void
+parallel_sort_ranges (std::vector<NumericRange<T> > &ranges, ThreadPool &pool)
+{
+  const std::size_t n = ranges.size();
+  const std::size_t threads = pool.size();
+  if constexpr (!detail::has_radix_key<T>::value)
+  {
+    sort_ranges(ranges);
+  }
+  else if (threads < 2 || n < detail::parallel_cutoff)
+  {
+    sort_ranges(ranges);
+  }
+  else
+  {
+    // Left uninitialized so that each thread touches its own slice first
+    std::unique_ptr<detail::RadixItem[]> items(new detail::RadixItem[n]);
+    std::unique_ptr<detail::RadixItem[]> buffer(new detail::RadixItem[n]);
+    std::unique_ptr<unsigned char[]> exclusive(new unsigned char[n]);
+    const detail::RadixItemLess less{exclusive.get()};
+
+    std::vector<std::size_t> runs(threads + 1);
+    for (std::size_t t = 0; t <= threads; ++t)
+    {
+      runs[t] = n * t / threads;
+    }
+
+    pool.parallel_for(threads, [&] (std::size_t t) {
+      const std::size_t begin = runs[t];
+      const std::size_t end = runs[t + 1];
+      for (std::size_t i = begin; i < end; ++i)
+      {
+        items[i] = {detail::order_preserving_key(ranges[i].lb), i};
+        exclusive[i] = !ranges[i].lb_inclusive;
+      }
+      const detail::RadixItem *result = detail::sort_items<T>(
+          &items[begin], &buffer[begin], end - begin, exclusive.get());
+      if (result != &items[begin])
+      {
+        std::copy(result, result + (end - begin), &items[begin]);
+      }
+    });
+
+    // Merge adjacent runs until one is left. A trailing run without a
+    // partner is merged with an empty run, i.e. copied.
+    while (runs.size() > 2)
+    {
+      const std::size_t pairs = runs.size() / 2;
+      const std::size_t slices = std::max<std::size_t>(1, threads / pairs);
+      pool.parallel_for(pairs * slices, [&] (std::size_t task) {
+        const std::size_t p = task / slices;
+        const std::size_t slice = task % slices;
+        const std::size_t begin = runs[2 * p];
+        const std::size_t mid = runs[std::min(2 * p + 1, runs.size() - 1)];
+        const std::size_t end = runs[std::min(2 * p + 2, runs.size() - 1)];
+        const detail::RadixItem *left = &items[begin];
+        const detail::RadixItem *right = &items[mid];
+        const std::size_t left_n = mid - begin;
+        const std::size_t right_n = end - mid;
+
+        const std::size_t d0 = (end - begin) * slice / slices;
+        const std::size_t d1 = (end - begin) * (slice + 1) / slices;
+        const std::size_t i0 = detail::merge_path_split(
+            left, left_n, right, right_n, d0, less);
+        const std::size_t i1 = detail::merge_path_split(
+            left, left_n, right, right_n, d1, less);
+        std::merge(left + i0, left + i1, right + (d0 - i0), right + (d1 - i1),
+                   &buffer[begin + d0], less);
+      });
+      std::swap(items, buffer);
+
+      std::vector<std::size_t> merged;
+      for (std::size_t r = 0; r < runs.size(); r += 2)
+      {
+        merged.push_back(runs[r]);
+      }
+      if (merged.back() != n)
+      {
+        merged.push_back(n);
+      }
+      runs.swap(merged);
+    }
+
+    std::vector<NumericRange<T> > sorted(ranges);
+    pool.parallel_for(threads, [&] (std::size_t t) {
+      for (std::size_t i = n * t / threads; i < n * (t + 1) / threads; ++i)
+      {
+        sorted[i] = ranges[items[i].pos];
+      }
+    });
+    ranges.swap(sorted);
+  }
+}
+
+/**
+ * disjoint_sorted_until for random access iterators, checking slices of
+ * the sequence on all threads of pool. The result is the same as that of
+ * the serial version.
+ * @param first
+ * @param last
+ * @param pool
+ * @return Iterator to the second range of the first offending adjacent
+ * pair, or last if the sequence is strictly sorted
+ */
+template<typename RandomIt>
+RandomIt
+parallel_disjoint_sorted_until (RandomIt first, RandomIt last,
+                                ThreadPool &pool)
+{
+  const std::size_t n = std::size_t(std::distance(first, last));
+  if (pool.size() < 2 || n < detail::parallel_cutoff)
+  {
+    return disjoint_sorted_until(first, last);
+  }
+
+  // More slices than threads so that an early mismatch lets the remaining
+  // slices after it be skipped.
+  const std::size_t slices = std::size_t(pool.size()) * 4;
+  std::atomic<std::size_t> found{n};
+  pool.parallel_for(slices, [&] (std::size_t s) {
+    const std::size_t begin = std::max<std::size_t>(1, n * s / slices);
+    const std::size_t end = n * (s + 1) / slices;
+    for (std::size_t i = begin;
+         i < end && i < found.load(std::memory_order_relaxed); ++i)
+    {
+      if (compare(first[i - 1], first[i]) != RangeOrdering::less)
+      {
+        std::size_t current = found.load(std::memory_order_relaxed);
+        while (i < current && !found.compare_exchange_weak(current, i)) {}
+        return;
+      }
+    }
+  });
+  return first + std::ptrdiff_t(found.load());
+}
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_PARALLEL_SORT_HPP
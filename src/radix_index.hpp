@@ -0,0 +1,318 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A static two-level index over sorted, non-overlapping integral ranges. A
+ * direct-indexed table keyed on the high bits of a scalar narrows the search
+ * down to the few lower bounds that share those bits, which are then counted
+ * with a single short scan instead of a search over the whole table.
+ */
+
+#ifndef NUMERIC_RANGE_RADIX_INDEX_HPP
+#define NUMERIC_RANGE_RADIX_INDEX_HPP
+
+#include "cache_utils.hpp"
+#include "interpolation_search.hpp"
+#include "numeric_range.hpp"
+#include "radix_simd.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * An immutable index answering "which range contains x" for sorted,
+ * non-overlapping integral ranges, with the same semantics as
+ * NumericRangeComparator.
+ * Bounds are stored in closed canonical form as unsigned keys, with the
+ * sign bit of signed types flipped so that key order matches value order.
+ * The span of lower bounds is cut into at most 2^radix_bits() slots of equal
+ * width, and a top-level table records where the lower bounds of every slot
+ * start. A lookup reads the two table entries of its slot and counts the
+ * lower bounds <= x between them, scanning at most scan_width of them at
+ * once; slots holding more bounds than that are searched instead.
+ * The number of bits is chosen from the data at build time: enough for
+ * about half a scan of lower bounds per slot when they are evenly spread,
+ * plus a few more while too many ranges are left in runs longer than a scan.
+ * @tparam T An integral type, typically std::uint32_t or std::uint64_t.
+ */
+template<typename T>
+class RadixRangeIndex
+{
+  static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value,
+                "RadixRangeIndex requires an integral type");
+
+  using key_type = detail::radix_key_t<T>;
+
+public:
+  using index_type = std::uint32_t;
+
+  /// Returned by lookups when no range contains the value.
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  /// Number of lower bounds counted by one scan, a cache line worth.
+  static constexpr std::size_t scan_width =
+      detail::cache_line_size / sizeof(T);
+
+  /// Largest number of radix bits, which caps the table at 64 MiB.
+  static constexpr unsigned max_radix_bits = 24;
+
+  RadixRangeIndex () = default;
+
+  /**
+   * Build the index from a sequence of NumericRange<T> sorted by
+   * NumericRangeComparator<T>, validated in one linear pass.
+   * @param first
+   * @param last
+   * @throws runtime_error If the sequence overlaps or is not strictly sorted,
+   * naming the first offending pair
+   * @throws length_error If the sequence has npos or more elements
+   */
+  template<typename InputIt>
+  RadixRangeIndex (InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      build(first, last);
+    }
+    else
+    {
+      const std::vector<NumericRange<T> > sorted(first, last);
+      build(sorted.begin(), sorted.end());
+    }
+  }
+
+  explicit RadixRangeIndex (const std::vector<NumericRange<T> > &sorted) :
+      RadixRangeIndex(sorted.begin(), sorted.end())
+  {}
+
+  /**
+   * Find the range containing the scalar x, with the same semantics as
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range in the sorted input, or npos
+   */
+  index_type
+  find (const T x) const
+  {
+    const key_type k = to_key(x);
+    if (ub_.empty() || k < lo_)
+    {
+      return npos;
+    }
+    const std::size_t slot = std::min(std::size_t(key_type(k - lo_) >> shift_),
+                                      last_slot_);
+    const std::size_t begin = start_[slot];
+    const std::size_t len = start_[slot + 1] - begin;
+    const key_type *lb = lb_.data();
+    std::size_t count = 0;
+    if (len <= scan_width)
+    {
+      for (std::size_t i = 0; i < len; ++i)
+      {
+        count += lb[begin + i] <= k;
+      }
+    }
+    else
+    {
+      const std::size_t pos = detail::last_le(lb, begin, begin + len, k);
+      count = pos - begin + (lb[pos] <= k);
+    }
+    // Every lower bound before the slot is <= x, so begin + count of them
+    // are, and the last of those holds the only candidate
+    const std::size_t le = begin + count;
+    return le != 0 && k <= ub_[le - 1] ? index_type(le - 1) : npos;
+  }
+
+  /**
+   * Look up many scalars at once. For 32/64-bit T on x86-64 CPUs with AVX2
+   * or AVX-512, the lower bounds of a slot are counted with vector
+   * compares; otherwise this is equivalent to calling find() for every key.
+   * @param keys Array of n scalars
+   * @param n
+   * @param out Array of n positions, set as by find()
+   */
+  void
+  lookup_batch (const T *keys, std::size_t n, index_type *out) const
+  {
+    static_assert(sizeof(index_type) == sizeof(std::uint32_t),
+                  "SIMD kernels produce 32-bit positions");
+    std::size_t done = 0;
+    if (!ub_.empty())
+    {
+      const detail::RadixView<key_type> view{lb_.data(), ub_.data(),
+                                             start_.data(), lo_, shift_,
+                                             last_slot_};
+      done = detail::radix_batch_simd(view, keys, n, out);
+    }
+    for (; done < n; ++done)
+    {
+      out[done] = find(keys[done]);
+    }
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find(x) != npos;
+  }
+
+  std::size_t size () const { return ub_.size(); }
+  bool empty () const { return ub_.empty(); }
+
+  /**
+   * @return Number of high bits of a scalar, relative to the smallest lower
+   * bound, that select its slot
+   */
+  unsigned radix_bits () const { return bits_; }
+
+  std::size_t slot_count () const { return ub_.empty() ? 0 : last_slot_ + 1; }
+
+  /**
+   * @return Largest number of lower bounds in one slot
+   */
+  std::size_t max_run () const { return max_run_; }
+
+  /**
+   * @return Bytes taken by the top-level table
+   */
+  std::size_t table_size () const { return start_.size() * sizeof(index_type); }
+
+  /**
+   * @return Bytes of heap storage used by the index.
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity()) * sizeof(key_type)
+           + start_.capacity() * sizeof(index_type);
+  }
+
+private:
+  // Average number of lower bounds per slot aimed for, so that most slots
+  // fit one scan and the table stays several times smaller than the bounds
+  static constexpr std::size_t target_run = scan_width / 2;
+
+  // A few more bits are tried when lower bounds cluster
+  static constexpr unsigned extra_radix_bits = 3;
+
+  // Closed lower bounds, followed by scan_width padding keys for the
+  // vector loads of lookup_batch()
+  detail::aligned_vector<key_type> lb_;
+  detail::aligned_vector<key_type> ub_;
+  // Position of the first lower bound of every slot, and size()
+  detail::aligned_vector<index_type> start_;
+  key_type lo_ = 0;
+  unsigned shift_ = 0;
+  unsigned bits_ = 0;
+  std::size_t last_slot_ = 0;
+  std::size_t max_run_ = 0;
+
+  static key_type
+  to_key (const T x)
+  {
+    return detail::radix_key(x);
+  }
+
+  static unsigned
+  bit_width (std::uint64_t v)
+  {
+    unsigned width = 0;
+    for (; v != 0; v >>= 1)
+    {
+      ++width;
+    }
+    return width;
+  }
+
+  template<typename ForwardIt>
+  void
+  build (ForwardIt first, ForwardIt last)
+  {
+    const std::size_t n = std::size_t(std::distance(first, last));
+    if (n >= npos)
+    {
+      NUMERIC_RANGE_THROW(std::length_error(
+          "Too many ranges for RadixRangeIndex"));
+    }
+    detail::check_disjoint_sorted(first, last);
+    if (n == 0)
+    {
+      return;
+    }
+
+    lb_.reserve(n + scan_width);
+    ub_.reserve(n);
+    for (; first != last; ++first)
+    {
+      // Closed lower bounds never decrease, even around empty ranges
+      lb_.push_back(to_key(detail::closed_lb(*first)));
+      ub_.push_back(to_key(detail::closed_ub(*first)));
+    }
+    lb_.insert(lb_.end(), scan_width, std::numeric_limits<key_type>::max());
+    lo_ = lb_[0];
+
+    const unsigned span_bits = bit_width(key_type(lb_[n - 1] - lo_));
+    const unsigned cap = std::min(span_bits, max_radix_bits);
+    unsigned bits = std::min(std::max(bit_width((n - 1) / target_run), 1u),
+                             cap);
+    const unsigned most = std::min(bits + extra_radix_bits, cap);
+    // Clustered bounds leave long runs however narrow the slots are, so
+    // more bits are only spent while they move enough ranges into scans
+    while (fill_slots(bits) > n / 8 && bits < most)
+    {
+      ++bits;
+    }
+  }
+
+  /**
+   * Lay out the top-level table for the given number of radix bits.
+   * @return Number of ranges in slots too long for one scan
+   */
+  std::size_t
+  fill_slots (unsigned bits)
+  {
+    const std::size_t n = ub_.size();
+    const key_type span = key_type(lb_[n - 1] - lo_);
+    bits_ = bits;
+    shift_ = bit_width(span) - bits;
+    last_slot_ = std::size_t(span >> shift_);
+    start_.assign(last_slot_ + 2, index_type(n));
+
+    std::size_t pos = 0;
+    for (std::size_t slot = 0; slot <= last_slot_; ++slot)
+    {
+      // No overflow: the first key of the last slot is <= lb_[n - 1]
+      const key_type first_key = key_type(lo_ + (key_type(slot) << shift_));
+      while (pos < n && lb_[pos] < first_key)
+      {
+        ++pos;
+      }
+      start_[slot] = index_type(pos);
+    }
+
+    max_run_ = 0;
+    std::size_t long_runs = 0;
+    for (std::size_t slot = 0; slot <= last_slot_; ++slot)
+    {
+      const std::size_t run = start_[slot + 1] - start_[slot];
+      max_run_ = std::max(max_run_, run);
+      long_runs += run > scan_width ? run : 0;
+    }
+    return long_runs;
+  }
+}; /* class RadixRangeIndex */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RADIX_INDEX_HPP
@@ -0,0 +1,304 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * AVX2 and AVX-512 kernels for batched lookups in a RadixRangeIndex. The
+ * slot of each key is found with scalar code, and the lower bounds of the
+ * slot, one cache line of them, are then compared with the key in one or
+ * two vector compares whose mask is counted.
+ */
+
+#ifndef NUMERIC_RANGE_RADIX_SIMD_HPP
+#define NUMERIC_RANGE_RADIX_SIMD_HPP
+
+#include "interpolation_search.hpp"
+#include "simd_dispatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace numeric_range {
+
+namespace detail {
+
+template<typename T>
+using radix_key_t = typename std::make_unsigned<T>::type;
+
+/**
+ * @param x
+ * @return x as an unsigned key of the same width, with the sign bit of
+ * signed types flipped so that keys sort like values
+ */
+template<typename T>
+radix_key_t<T>
+radix_key (const T x)
+{
+  using key_type = radix_key_t<T>;
+  if constexpr (std::is_signed<T>::value)
+  {
+    constexpr key_type sign_bit =
+        key_type(1) << (std::numeric_limits<key_type>::digits - 1);
+    return key_type(key_type(x) ^ sign_bit);
+  }
+  else
+  {
+    return x;
+  }
+}
+
+/**
+ * Read-only view of the arrays of a RadixRangeIndex with at least one
+ * range. lb is padded so that a full line can be read from any slot.
+ */
+template<typename K>
+struct RadixView
+{
+  const K *lb;
+  const K *ub;
+  const std::uint32_t *start;
+  K lo;
+  unsigned shift;
+  std::size_t last_slot;
+};
+
+/**
+ * Locate the lower bounds of the slot of k.
+ * @return False if k is below every lower bound
+ */
+template<typename K>
+inline bool
+radix_slot (const RadixView<K> &v, const K k, std::size_t &begin,
+            std::size_t &len)
+{
+  if (k < v.lo)
+  {
+    return false;
+  }
+  std::size_t slot = std::size_t(K(k - v.lo) >> v.shift);
+  slot = slot < v.last_slot ? slot : v.last_slot;
+  begin = v.start[slot];
+  len = v.start[slot + 1] - begin;
+  return true;
+}
+
+/**
+ * Count the lower bounds <= k in a slot too long for one scan.
+ */
+template<typename K>
+inline std::size_t
+radix_count_search (const RadixView<K> &v, const K k, std::size_t begin,
+                    std::size_t len)
+{
+  const std::size_t pos = last_le(v.lb, begin, begin + len, k);
+  return pos - begin + (v.lb[pos] <= k);
+}
+
+/**
+ * @param le Number of lower bounds <= k
+ * @return Position of the range containing k, or 0xFFFFFFFF
+ */
+template<typename K>
+inline std::uint32_t
+radix_resolve (const RadixView<K> &v, const K k, std::size_t le)
+{
+  return le != 0 && k <= v.ub[le - 1] ? std::uint32_t(le - 1) : UINT32_MAX;
+}
+
+#ifdef NUMERIC_RANGE_X86_SIMD
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+radix_batch_avx512_32 (const RadixView<radix_key_t<T> > &v, const T *keys,
+                       std::size_t n, std::uint32_t *out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto k = radix_key(keys[i]);
+    std::size_t begin, len;
+    if (!radix_slot(v, k, begin, len))
+    {
+      out[i] = UINT32_MAX;
+      continue;
+    }
+    std::size_t count;
+    if (len <= 16)
+    {
+      const __mmask16 run = __mmask16((1u << len) - 1);
+      const __m512i lb = _mm512_maskz_loadu_epi32(run, v.lb + begin);
+      const __mmask16 le = _mm512_mask_cmple_epu32_mask(
+          run, lb, _mm512_set1_epi32(int(k)));
+      count = std::size_t(__builtin_popcount(le));
+    }
+    else
+    {
+      count = radix_count_search(v, k, begin, len);
+    }
+    out[i] = radix_resolve(v, k, begin + count);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx512f"))) inline void
+radix_batch_avx512_64 (const RadixView<radix_key_t<T> > &v, const T *keys,
+                       std::size_t n, std::uint32_t *out)
+{
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto k = radix_key(keys[i]);
+    std::size_t begin, len;
+    if (!radix_slot(v, k, begin, len))
+    {
+      out[i] = UINT32_MAX;
+      continue;
+    }
+    std::size_t count;
+    if (len <= 8)
+    {
+      const __mmask8 run = __mmask8((1u << len) - 1);
+      const __m512i lb = _mm512_maskz_loadu_epi64(run, v.lb + begin);
+      const __mmask8 le = _mm512_mask_cmple_epu64_mask(
+          run, lb, _mm512_set1_epi64((long long) k));
+      count = std::size_t(__builtin_popcount(le));
+    }
+    else
+    {
+      count = radix_count_search(v, k, begin, len);
+    }
+    out[i] = radix_resolve(v, k, begin + count);
+  }
+}
+
+// AVX2 only has signed compares, which order unsigned keys correctly once
+// their sign bits are flipped
+template<typename T>
+__attribute__((target("avx2"))) inline void
+radix_batch_avx2_32 (const RadixView<radix_key_t<T> > &v, const T *keys,
+                     std::size_t n, std::uint32_t *out)
+{
+  const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto k = radix_key(keys[i]);
+    std::size_t begin, len;
+    if (!radix_slot(v, k, begin, len))
+    {
+      out[i] = UINT32_MAX;
+      continue;
+    }
+    std::size_t count;
+    if (len <= 16)
+    {
+      const __m256i x = _mm256_xor_si256(_mm256_set1_epi32(int(k)), flip);
+      const __m256i *lb = reinterpret_cast<const __m256i *>(v.lb + begin);
+      const __m256i gt_lo = _mm256_cmpgt_epi32(
+          _mm256_xor_si256(_mm256_loadu_si256(lb), flip), x);
+      const __m256i gt_hi = _mm256_cmpgt_epi32(
+          _mm256_xor_si256(_mm256_loadu_si256(lb + 1), flip), x);
+      const unsigned gt =
+          unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(gt_lo)))
+          | unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(gt_hi))) << 8;
+      count = std::size_t(__builtin_popcount(~gt & ((1u << len) - 1)));
+    }
+    else
+    {
+      count = radix_count_search(v, k, begin, len);
+    }
+    out[i] = radix_resolve(v, k, begin + count);
+  }
+}
+
+template<typename T>
+__attribute__((target("avx2"))) inline void
+radix_batch_avx2_64 (const RadixView<radix_key_t<T> > &v, const T *keys,
+                     std::size_t n, std::uint32_t *out)
+{
+  const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    const auto k = radix_key(keys[i]);
+    std::size_t begin, len;
+    if (!radix_slot(v, k, begin, len))
+    {
+      out[i] = UINT32_MAX;
+      continue;
+    }
+    std::size_t count;
+    if (len <= 8)
+    {
+      const __m256i x = _mm256_xor_si256(
+          _mm256_set1_epi64x((long long) k), flip);
+      const __m256i *lb = reinterpret_cast<const __m256i *>(v.lb + begin);
+      const __m256i gt_lo = _mm256_cmpgt_epi64(
+          _mm256_xor_si256(_mm256_loadu_si256(lb), flip), x);
+      const __m256i gt_hi = _mm256_cmpgt_epi64(
+          _mm256_xor_si256(_mm256_loadu_si256(lb + 1), flip), x);
+      const unsigned gt =
+          unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(gt_lo)))
+          | unsigned(_mm256_movemask_pd(_mm256_castsi256_pd(gt_hi))) << 4;
+      count = std::size_t(__builtin_popcount(~gt & ((1u << len) - 1)));
+    }
+    else
+    {
+      count = radix_count_search(v, k, begin, len);
+    }
+    out[i] = radix_resolve(v, k, begin + count);
+  }
+}
+
+#endif /* NUMERIC_RANGE_X86_SIMD */
+
+/**
+ * Run the widest available kernel over every key.
+ * @return Number of leading keys processed; the caller handles the rest
+ */
+template<typename T>
+std::size_t
+radix_batch_simd (const RadixView<radix_key_t<T> > &v, const T *keys,
+                  std::size_t count, std::uint32_t *out)
+{
+#ifdef NUMERIC_RANGE_X86_SIMD
+  if constexpr (sizeof(T) == 4 || sizeof(T) == 8)
+  {
+    const SimdLevel level = simd_level();
+    if (level == SimdLevel::avx512)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        radix_batch_avx512_32(v, keys, count, out);
+      }
+      else
+      {
+        radix_batch_avx512_64(v, keys, count, out);
+      }
+      return count;
+    }
+    if (level == SimdLevel::avx2)
+    {
+      if constexpr (sizeof(T) == 4)
+      {
+        radix_batch_avx2_32(v, keys, count, out);
+      }
+      else
+      {
+        radix_batch_avx2_64(v, keys, count, out);
+      }
+      return count;
+    }
+  }
+#endif
+  (void) v;
+  (void) keys;
+  (void) count;
+  (void) out;
+  return 0;
+}
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RADIX_SIMD_HPP
@@ -0,0 +1,1085 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * An in-memory B+tree mapping non-overlapping NumericRange keys to values,
+ * for tables that see a steady stream of inserts and erases as well as
+ * lookups. Nodes span a few cache lines and keep their bounds in plain
+ * arrays, and the leaves are linked for ordered scans.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_BTREE_HPP
+#define NUMERIC_RANGE_RANGE_BTREE_HPP
+
+#include "cache_utils.hpp"
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A RangeBTree is a drop-in alternative to
+ * std::map<NumericRange<T>, V, NumericRangeComparator<T> > for workloads
+ * that mix lookups with inserts and erases, where the O(n) updates of
+ * RangeMap are too slow. Inner nodes hold the lower bounds that separate
+ * their children, leaves hold up to node_capacity ranges and their values,
+ * and all nodes live in two pools addressed by 32-bit indices.
+ * Lookups, inserts and erases are O(log n) and touch a few adjacent cache
+ * lines per level instead of one heap node per comparison.
+ * Like std::map with NumericRangeComparator, inserting a range that overlaps
+ * an existing one throws a runtime_error.
+ * Nodes that fall below a quarter full are merged with a sibling when the
+ * two fit into one node.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam V Mapped value type, which must be default constructible.
+ */
+template<typename T, typename V>
+class RangeBTree
+{
+  static_assert(std::is_default_constructible<V>::value,
+                "RangeBTree requires a default constructible value type");
+
+  template<bool IsConst>
+  class basic_iterator;
+
+public:
+  using key_type = NumericRange<T>;
+  using mapped_type = V;
+  using key_compare = NumericRangeComparator<T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  /// Children per inner node and ranges per leaf: two cache lines of bounds.
+  static constexpr size_type node_capacity = std::min<size_type>(
+      64, std::max<size_type>(8, 2 * detail::cache_line_size / sizeof(T)));
+
+  /**
+   * Result of try_insert. On success, or if an equivalent key exists,
+   * position refers to that element. On overlap it refers to an element
+   * that conflicts with the range being inserted.
+   */
+  struct insert_result
+  {
+    iterator position;
+    InsertStatus status;
+  };
+
+  RangeBTree () = default;
+
+  /**
+   * Insert a range and its value.
+   * If an equivalent key already exists (the same range, or a range
+   * containing the scalar being inserted), nothing is inserted.
+   * @param range
+   * @param value
+   * @return Iterator to the inserted or existing element, and whether the
+   * insertion took place
+   * @throws runtime_error If range overlaps a range already in the tree
+   */
+  std::pair<iterator, bool>
+  insert (const NumericRange<T> &range, const V &value)
+  {
+    return checked_insert(try_insert(range, value));
+  }
+
+  std::pair<iterator, bool>
+  insert (const NumericRange<T> &range, V &&value)
+  {
+    return checked_insert(try_insert(range, std::move(value)));
+  }
+
+  std::pair<iterator, bool>
+  insert (const std::pair<NumericRange<T>, V> &kv)
+  {
+    return checked_insert(try_insert(kv.first, kv.second));
+  }
+
+  /**
+   * Insert a range and its value, reporting conflicts through the return
+   * value instead of throwing. Suitable for builds without exceptions and
+   * for hot paths where overlaps are expected.
+   * @param range
+   * @param value
+   * @return The outcome of the insertion and the affected element
+   * @throws length_error If the tree outgrows its 32-bit node indices
+   */
+  template<typename U>
+  insert_result
+  try_insert (const NumericRange<T> &range, U &&value)
+  {
+    if (root_ == none)
+    {
+      root_ = first_leaf_ = last_leaf_ = new_leaf();
+      height_ = 1;
+    }
+    Match match{end_slot(), InsertStatus::inserted};
+    const Split split = insert_below<U>(root_, 1, range,
+                                        std::forward<U>(value), match);
+    if (split.node != none)
+    {
+      // The root split, so the tree grows by one level
+      const index_type root = new_inner();
+      Inner &inner = inners_[root];
+      inner.child[0] = root_;
+      inner.child[1] = split.node;
+      inner.lb[0] = split.lb;
+      inner.kinds[0] = split.kinds;
+      inner.count = 2;
+      root_ = root;
+      ++height_;
+    }
+    if (match.status == InsertStatus::inserted)
+    {
+      ++size_;
+    }
+    return {iterator(this, match.at), match.status};
+  }
+
+  /**
+   * Erase the element whose key is equivalent to range.
+   * @param range
+   * @return Number of elements erased (0 or 1)
+   * @throws runtime_error If range overlaps but is not equivalent to a key
+   */
+  size_type
+  erase (const NumericRange<T> &range)
+  {
+    const Slot at = find_equivalent(range);
+    if (at.leaf == none)
+    {
+      return 0;
+    }
+    erase_at(at);
+    return 1;
+  }
+
+  /**
+   * Erase the element at pos.
+   * @param pos Must be a valid, dereferenceable iterator into this tree
+   * @return Iterator following the erased element
+   */
+  iterator
+  erase (const_iterator pos)
+  {
+    const const_iterator next = std::next(pos);
+    if (next == cend())
+    {
+      erase_at(pos.slot_);
+      return end();
+    }
+    // Leaves may be merged, so look the successor up again afterwards
+    const Leaf &leaf = leaves_[next.slot_.leaf];
+    const T lb = leaf.lb[next.slot_.pos];
+    const std::uint8_t kinds = leaf.kinds[next.slot_.pos];
+    erase_at(pos.slot_);
+    return iterator(this, last_starting(lb, kinds & lb_inclusive_bit));
+  }
+
+  /**
+   * Find the range containing the scalar x.
+   * @param x
+   * @return Iterator to the containing element, or end() if none
+   */
+  iterator
+  find (const T &x)
+  {
+    return iterator(this, find_slot(x));
+  }
+
+  const_iterator
+  find (const T &x) const
+  {
+    return const_iterator(this, find_slot(x));
+  }
+
+  /**
+   * Find the element equivalent to range under NumericRangeComparator, i.e.
+   * the same range or, if range is a scalar, the range containing it.
+   * @param range
+   * @return Iterator to the equivalent element, or end() if none
+   * @throws runtime_error If range overlaps but is not equivalent to a key
+   */
+  iterator
+  find (const NumericRange<T> &range)
+  {
+    return iterator(this, find_equivalent(range));
+  }
+
+  const_iterator
+  find (const NumericRange<T> &range) const
+  {
+    return const_iterator(this, find_equivalent(range));
+  }
+
+  bool
+  contains (const T &x) const
+  {
+    return find_slot(x).leaf != none;
+  }
+
+  /**
+   * Access the value mapped to the range containing x.
+   * @param x
+   * @return Reference to the mapped value
+   * @throws out_of_range If no range contains x
+   */
+  V &
+  at (const T &x)
+  {
+    const Slot at = checked_find_slot(x);
+    return leaves_[at.leaf].values[at.pos];
+  }
+
+  const V &
+  at (const T &x) const
+  {
+    const Slot at = checked_find_slot(x);
+    return leaves_[at.leaf].values[at.pos];
+  }
+
+  iterator begin () { return iterator(this, first_slot()); }
+  iterator end () { return iterator(this, end_slot()); }
+  const_iterator begin () const { return const_iterator(this, first_slot()); }
+  const_iterator end () const { return const_iterator(this, end_slot()); }
+  const_iterator cbegin () const { return begin(); }
+  const_iterator cend () const { return end(); }
+
+  size_type size () const { return size_; }
+  bool empty () const { return size_ == 0; }
+
+  /**
+   * @return Number of levels: 0 when empty, 1 while the root is a leaf
+   */
+  size_type height () const { return height_; }
+
+  void
+  clear ()
+  {
+    leaves_.clear();
+    inners_.clear();
+    free_leaves_.clear();
+    free_inners_.clear();
+    root_ = first_leaf_ = last_leaf_ = none;
+    height_ = 0;
+    size_ = 0;
+  }
+
+  /**
+   * @return Bytes of heap storage used by the tree
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return leaves_.capacity() * sizeof(Leaf)
+           + inners_.capacity() * sizeof(Inner)
+           + (free_leaves_.capacity() + free_inners_.capacity())
+             * sizeof(index_type);
+  }
+
+private:
+  using index_type = std::uint32_t;
+
+  static constexpr index_type none = std::numeric_limits<index_type>::max();
+  static constexpr index_type min_fill = index_type(node_capacity / 4);
+  static constexpr std::uint8_t lb_inclusive_bit = 1;
+  static constexpr std::uint8_t ub_inclusive_bit = 2;
+
+  /**
+   * count children and count - 1 separators. Every range below child i
+   * starts no earlier than separator i - 1 and before separator i.
+   */
+  struct alignas(detail::cache_line_size) Inner
+  {
+    T lb[node_capacity - 1];
+    std::uint8_t kinds[node_capacity - 1];
+    index_type child[node_capacity];
+    index_type count = 0;
+  };
+
+  struct alignas(detail::cache_line_size) Leaf
+  {
+    T lb[node_capacity];
+    T ub[node_capacity];
+    std::uint8_t kinds[node_capacity];
+    index_type count = 0;
+    index_type prev = none;
+    index_type next = none;
+    V values[node_capacity];
+  };
+
+  struct Slot
+  {
+    index_type leaf;
+    index_type pos;
+  };
+
+  struct Match
+  {
+    Slot at;
+    InsertStatus status;
+  };
+
+  /// Separator and right half of a node that split, if node != none.
+  struct Split
+  {
+    T lb;
+    std::uint8_t kinds;
+    index_type node;
+  };
+
+  std::vector<Leaf, detail::AlignedAllocator<Leaf> > leaves_;
+  std::vector<Inner, detail::AlignedAllocator<Inner> > inners_;
+  std::vector<index_type> free_leaves_;
+  std::vector<index_type> free_inners_;
+  index_type root_ = none;
+  index_type first_leaf_ = none;
+  index_type last_leaf_ = none;
+  unsigned height_ = 0;
+  size_type size_ = 0;
+
+  /**
+   * Whether the lower bound (lb, kinds) starts no later than a lower bound
+   * at u. At the same value, an inclusive bound starts before an exclusive
+   * one. A scalar x starts like the inclusive bound at x.
+   */
+  static bool
+  starts_by (const T &lb, std::uint8_t kinds, const T &u, bool u_inclusive)
+  {
+    return (lb < u) | ((lb == u) & (bool(kinds & lb_inclusive_bit)
+                                    | !u_inclusive));
+  }
+
+  /**
+   * @return How many of the n sorted lower bounds start no later than u
+   */
+  static index_type
+  rank (const T *lb, const std::uint8_t *kinds, index_type n, const T &u,
+        bool u_inclusive)
+  {
+    // Counting over the whole node has no unpredictable branches
+    index_type count = 0;
+    for (index_type i = 0; i < n; ++i)
+    {
+      count += index_type(starts_by(lb[i], kinds[i], u, u_inclusive));
+    }
+    return count;
+  }
+
+  static std::uint8_t
+  kinds_of (const NumericRange<T> &range)
+  {
+    return std::uint8_t((range.lb_inclusive ? lb_inclusive_bit : 0)
+                        | (range.ub_inclusive ? ub_inclusive_bit : 0));
+  }
+
+  std::pair<iterator, bool>
+  checked_insert (const insert_result &result)
+  {
+    if (result.status == InsertStatus::overlap)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Invalid comparison between overlapping ranges"));
+    }
+    return {result.position, result.status == InsertStatus::inserted};
+  }
+
+  Slot end_slot () const { return {none, 0}; }
+
+  Slot
+  first_slot () const
+  {
+    return first_leaf_ == none ? end_slot() : Slot{first_leaf_, 0};
+  }
+
+  /**
+   * Descend to the leaf where a range starting at u belongs.
+   * @return The leaf and how many of its ranges start no later than u
+   */
+  Slot
+  descend (const T &u, bool u_inclusive) const
+  {
+    index_type node = root_;
+    for (unsigned level = 1; level < height_; ++level)
+    {
+      const Inner &inner = inners_[node];
+      node = inner.child[rank(inner.lb, inner.kinds, inner.count - 1, u,
+                              u_inclusive)];
+    }
+    const Leaf &leaf = leaves_[node];
+    return {node, rank(leaf.lb, leaf.kinds, leaf.count, u, u_inclusive)};
+  }
+
+  /**
+   * Position before which a range starting at u would be inserted. If no
+   * range of the leaf starts by u, this is position 0 of the leaf, and the
+   * range before it is the last one of the previous leaf.
+   */
+  Slot
+  predecessor (Slot slot) const
+  {
+    if (slot.pos > 0)
+    {
+      return {slot.leaf, slot.pos - 1};
+    }
+    const index_type prev = leaves_[slot.leaf].prev;
+    return prev == none ? end_slot() : Slot{prev, leaves_[prev].count - 1};
+  }
+
+  Slot
+  successor (Slot slot) const
+  {
+    const Leaf &leaf = leaves_[slot.leaf];
+    if (slot.pos < leaf.count)
+    {
+      return slot;
+    }
+    return leaf.next == none ? end_slot() : Slot{leaf.next, 0};
+  }
+
+  /**
+   * @return The last range that starts no later than u, or end_slot()
+   */
+  Slot
+  last_starting (const T &u, bool u_inclusive) const
+  {
+    if (root_ == none)
+    {
+      return end_slot();
+    }
+    return predecessor(descend(u, u_inclusive));
+  }
+
+  Slot
+  find_slot (const T &x) const
+  {
+    // NaN starts after no range, so this is end_slot() as well
+    const Slot at = last_starting(x, true);
+    if (at.leaf == none)
+    {
+      return at;
+    }
+    const Leaf &leaf = leaves_[at.leaf];
+    const bool below_ub = (x < leaf.ub[at.pos])
+                          | ((x == leaf.ub[at.pos])
+                             & bool(leaf.kinds[at.pos] & ub_inclusive_bit));
+    return below_ub ? at : end_slot();
+  }
+
+  Slot
+  checked_find_slot (const T &x) const
+  {
+    const Slot at = find_slot(x);
+    if (at.leaf == none)
+    {
+      NUMERIC_RANGE_THROW(std::out_of_range(
+          "No range contains the given value"));
+    }
+    return at;
+  }
+
+  NumericRange<T>
+  key_at (Slot at) const
+  {
+    const Leaf &leaf = leaves_[at.leaf];
+    const std::uint8_t kinds = leaf.kinds[at.pos];
+    return NumericRange<T>(leaf.lb[at.pos], kinds & lb_inclusive_bit,
+                           leaf.ub[at.pos], kinds & ub_inclusive_bit);
+  }
+
+  /**
+   * Compare range with its neighbors, the last range starting no later and
+   * the first range starting later, the only two it can conflict with.
+   * @param range
+   * @param slot Result of descend for the lower bound of range
+   * @return Status inserted and slot if range fits in between, otherwise
+   * the conflicting neighbor
+   */
+  Match
+  match_neighbors (const NumericRange<T> &range, Slot slot) const
+  {
+    const key_compare comp;
+    const Slot before = predecessor(slot);
+    if (before.leaf != none)
+    {
+      switch (comp.compare(range, key_at(before)))
+      {
+        case RangeOrdering::greater:
+          break;
+        case RangeOrdering::overlap:
+          return {before, InsertStatus::overlap};
+        default:
+          return {before, InsertStatus::exists};
+      }
+    }
+    const Slot after = successor(slot);
+    if (after.leaf != none)
+    {
+      switch (comp.compare(range, key_at(after)))
+      {
+        case RangeOrdering::less:
+          break;
+        case RangeOrdering::overlap:
+          return {after, InsertStatus::overlap};
+        default:
+          return {after, InsertStatus::exists};
+      }
+    }
+    return {slot, InsertStatus::inserted};
+  }
+
+  /**
+   * @return Position of the key equivalent to range, or end_slot()
+   * @throws runtime_error If range overlaps a key
+   */
+  Slot
+  find_equivalent (const NumericRange<T> &range) const
+  {
+    if (root_ == none)
+    {
+      return end_slot();
+    }
+    const Match match = match_neighbors(
+        range, descend(range.lb, range.lb_inclusive));
+    switch (match.status)
+    {
+      case InsertStatus::inserted:
+        return end_slot();
+      case InsertStatus::overlap:
+        NUMERIC_RANGE_THROW(std::runtime_error(
+            "Invalid comparison between overlapping ranges"));
+      default:
+        return match.at;
+    }
+  }
+
+  static void
+  check_pool (std::size_t size)
+  {
+    if (size >= none)
+    {
+      NUMERIC_RANGE_THROW(std::length_error("Too many nodes for RangeBTree"));
+    }
+  }
+
+  index_type
+  new_leaf ()
+  {
+    if (!free_leaves_.empty())
+    {
+      const index_type index = free_leaves_.back();
+      free_leaves_.pop_back();
+      return index;
+    }
+    check_pool(leaves_.size());
+    leaves_.emplace_back();
+    return index_type(leaves_.size() - 1);
+  }
+
+  index_type
+  new_inner ()
+  {
+    if (!free_inners_.empty())
+    {
+      const index_type index = free_inners_.back();
+      free_inners_.pop_back();
+      return index;
+    }
+    check_pool(inners_.size());
+    inners_.emplace_back();
+    return index_type(inners_.size() - 1);
+  }
+
+  /**
+   * Remove a leaf from the chain of leaves and return it to the pool.
+   */
+  void
+  free_leaf (index_type index)
+  {
+    Leaf &leaf = leaves_[index];
+    (leaf.prev == none ? first_leaf_ : leaves_[leaf.prev].next) = leaf.next;
+    (leaf.next == none ? last_leaf_ : leaves_[leaf.next].prev) = leaf.prev;
+    leaf.count = 0;
+    leaf.prev = leaf.next = none;
+    free_leaves_.push_back(index);
+  }
+
+  void
+  free_inner (index_type index)
+  {
+    inners_[index].count = 0;
+    free_inners_.push_back(index);
+  }
+
+  /**
+   * Move the n ranges from position from of leaf src to position to of a
+   * different leaf dst, whose ranges from to on must already be moved.
+   */
+  void
+  move_ranges (index_type src, index_type from, index_type n, index_type dst,
+               index_type to)
+  {
+    Leaf &s = leaves_[src];
+    Leaf &d = leaves_[dst];
+    std::copy(s.lb + from, s.lb + from + n, d.lb + to);
+    std::copy(s.ub + from, s.ub + from + n, d.ub + to);
+    std::copy(s.kinds + from, s.kinds + from + n, d.kinds + to);
+    std::move(s.values + from, s.values + from + n, d.values + to);
+    // Release what the moved-from values still hold
+    std::fill(s.values + from, s.values + from + n, V());
+  }
+
+  /**
+   * Insert range into the subtree rooted at node, which is on the given
+   * level (1 is the root). match receives the outcome.
+   * @return The new right sibling of node if node had to split
+   */
+  template<typename U>
+  Split
+  insert_below (index_type node, unsigned level, const NumericRange<T> &range,
+                U &&value, Match &match)
+  {
+    if (level == height_)
+    {
+      return insert_into_leaf<U>(node, range, std::forward<U>(value), match);
+    }
+    index_type pos;
+    index_type child;
+    {
+      const Inner &inner = inners_[node];
+      pos = rank(inner.lb, inner.kinds, inner.count - 1, range.lb,
+                 range.lb_inclusive);
+      child = inner.child[pos];
+    }
+    const Split split = insert_below<U>(child, level + 1, range,
+                                        std::forward<U>(value), match);
+    if (split.node == none)
+    {
+      return split;
+    }
+    return insert_child(node, pos, split);
+  }
+
+  template<typename U>
+  Split
+  insert_into_leaf (index_type node, const NumericRange<T> &range, U &&value,
+                    Match &match)
+  {
+    Slot slot;
+    {
+      const Leaf &leaf = leaves_[node];
+      slot = {node, rank(leaf.lb, leaf.kinds, leaf.count, range.lb,
+                         range.lb_inclusive)};
+    }
+    match = match_neighbors(range, slot);
+    if (match.status != InsertStatus::inserted)
+    {
+      return {T(), 0, none};
+    }
+
+    Split split{T(), 0, none};
+    if (leaves_[node].count == node_capacity)
+    {
+      // Appending to the last leaf starts a new one instead of splitting it
+      // in half, so that ascending inserts fill their leaves completely
+      const index_type right = new_leaf();
+      Leaf &leaf = leaves_[node];
+      Leaf &r = leaves_[right];
+      const bool append = slot.pos == node_capacity && leaf.next == none;
+      const index_type mid = append ? index_type(node_capacity)
+                                    : index_type(node_capacity / 2);
+      move_ranges(node, mid, index_type(node_capacity) - mid, right, 0);
+      r.count = index_type(node_capacity) - mid;
+      leaf.count = mid;
+      r.prev = node;
+      r.next = leaf.next;
+      (leaf.next == none ? last_leaf_ : leaves_[leaf.next].prev) = right;
+      leaf.next = right;
+      if (slot.pos > mid || append)
+      {
+        slot = {right, slot.pos - mid};
+      }
+      split.node = right;
+    }
+
+    Leaf &leaf = leaves_[slot.leaf];
+    const index_type pos = slot.pos;
+    const index_type count = leaf.count;
+    std::copy_backward(leaf.lb + pos, leaf.lb + count, leaf.lb + count + 1);
+    std::copy_backward(leaf.ub + pos, leaf.ub + count, leaf.ub + count + 1);
+    std::copy_backward(leaf.kinds + pos, leaf.kinds + count,
+                       leaf.kinds + count + 1);
+    std::move_backward(leaf.values + pos, leaf.values + count,
+                       leaf.values + count + 1);
+    leaf.lb[pos] = range.lb;
+    leaf.ub[pos] = range.ub;
+    leaf.kinds[pos] = kinds_of(range);
+    leaf.values[pos] = std::forward<U>(value);
+    ++leaf.count;
+    match.at = slot;
+
+    if (split.node != none)
+    {
+      const Leaf &r = leaves_[split.node];
+      split.lb = r.lb[0];
+      split.kinds = r.kinds[0];
+    }
+    return split;
+  }
+
+  /**
+   * Add split.node as child pos + 1 of the inner node, splitting the inner
+   * node in turn if it is full.
+   * @return The new right sibling of node if node had to split
+   */
+  Split
+  insert_child (index_type node, index_type pos, const Split &split)
+  {
+    if (inners_[node].count < node_capacity)
+    {
+      Inner &inner = inners_[node];
+      const index_type count = inner.count;
+      std::copy_backward(inner.lb + pos, inner.lb + count - 1,
+                         inner.lb + count);
+      std::copy_backward(inner.kinds + pos, inner.kinds + count - 1,
+                         inner.kinds + count);
+      std::copy_backward(inner.child + pos + 1, inner.child + count,
+                         inner.child + count + 1);
+      inner.lb[pos] = split.lb;
+      inner.kinds[pos] = split.kinds;
+      inner.child[pos + 1] = split.node;
+      ++inner.count;
+      return {T(), 0, none};
+    }
+
+    // Lay out the overfull node, then move its upper half to a new node
+    T lb[node_capacity];
+    std::uint8_t kinds[node_capacity];
+    index_type child[node_capacity + 1];
+    {
+      const Inner &inner = inners_[node];
+      std::copy(inner.lb, inner.lb + pos, lb);
+      std::copy(inner.kinds, inner.kinds + pos, kinds);
+      std::copy(inner.child, inner.child + pos + 1, child);
+      lb[pos] = split.lb;
+      kinds[pos] = split.kinds;
+      child[pos + 1] = split.node;
+      std::copy(inner.lb + pos, inner.lb + node_capacity - 1, lb + pos + 1);
+      std::copy(inner.kinds + pos, inner.kinds + node_capacity - 1,
+                kinds + pos + 1);
+      std::copy(inner.child + pos + 1, inner.child + node_capacity,
+                child + pos + 2);
+    }
+    const index_type right = new_inner();
+    Inner &inner = inners_[node];
+    Inner &r = inners_[right];
+    // Children [0, mid) stay, separator mid - 1 moves up
+    const index_type mid = index_type(node_capacity + 1) / 2;
+    inner.count = mid;
+    std::copy(lb, lb + mid - 1, inner.lb);
+    std::copy(kinds, kinds + mid - 1, inner.kinds);
+    std::copy(child, child + mid, inner.child);
+    r.count = index_type(node_capacity + 1) - mid;
+    std::copy(lb + mid, lb + node_capacity, r.lb);
+    std::copy(kinds + mid, kinds + node_capacity, r.kinds);
+    std::copy(child + mid, child + node_capacity + 1, r.child);
+    return {lb[mid - 1], kinds[mid - 1], right};
+  }
+
+  void
+  erase_at (Slot at)
+  {
+    // Descending by the range's own lower bound leads to its leaf
+    const Leaf &leaf = leaves_[at.leaf];
+    const T lb = leaf.lb[at.pos];
+    const bool lb_inclusive = leaf.kinds[at.pos] & lb_inclusive_bit;
+    erase_below(root_, 1, lb, lb_inclusive);
+    --size_;
+
+    while (height_ > 1 && inners_[root_].count == 1)
+    {
+      const index_type root = root_;
+      root_ = inners_[root].child[0];
+      free_inner(root);
+      --height_;
+    }
+    if (size_ == 0)
+    {
+      clear();
+    }
+  }
+
+  void
+  erase_below (index_type node, unsigned level, const T &lb, bool lb_inclusive)
+  {
+    if (level == height_)
+    {
+      Leaf &leaf = leaves_[node];
+      const index_type pos = rank(leaf.lb, leaf.kinds, leaf.count, lb,
+                                  lb_inclusive) - 1;
+      const index_type count = leaf.count;
+      std::copy(leaf.lb + pos + 1, leaf.lb + count, leaf.lb + pos);
+      std::copy(leaf.ub + pos + 1, leaf.ub + count, leaf.ub + pos);
+      std::copy(leaf.kinds + pos + 1, leaf.kinds + count, leaf.kinds + pos);
+      std::move(leaf.values + pos + 1, leaf.values + count,
+                leaf.values + pos);
+      leaf.values[count - 1] = V();
+      --leaf.count;
+      return;
+    }
+    index_type pos;
+    index_type child;
+    {
+      const Inner &inner = inners_[node];
+      pos = rank(inner.lb, inner.kinds, inner.count - 1, lb, lb_inclusive);
+      child = inner.child[pos];
+    }
+    erase_below(child, level + 1, lb, lb_inclusive);
+    if (level + 1 == height_)
+    {
+      rebalance_leaf(node, pos);
+    }
+    else
+    {
+      rebalance_inner(node, pos);
+    }
+  }
+
+  /**
+   * Remove child pos of an inner node and the separator next to it.
+   */
+  void
+  remove_child (index_type node, index_type pos)
+  {
+    Inner &inner = inners_[node];
+    const index_type count = inner.count;
+    // Child 0 has no separator of its own, so drop the one after it
+    const index_type sep = pos == 0 ? 0 : pos - 1;
+    if (count > 1)
+    {
+      std::copy(inner.lb + sep + 1, inner.lb + count - 1, inner.lb + sep);
+      std::copy(inner.kinds + sep + 1, inner.kinds + count - 1,
+                inner.kinds + sep);
+    }
+    std::copy(inner.child + pos + 1, inner.child + count, inner.child + pos);
+    --inner.count;
+  }
+
+  /**
+   * Free leaf child pos of the inner node once it is empty, or merge it
+   * with a sibling once it is less than a quarter full.
+   */
+  void
+  rebalance_leaf (index_type node, index_type pos)
+  {
+    const Inner &inner = inners_[node];
+    const index_type child = inner.child[pos];
+    const index_type count = leaves_[child].count;
+    if (count == 0)
+    {
+      free_leaf(child);
+      remove_child(node, pos);
+      return;
+    }
+    if (count >= min_fill)
+    {
+      return;
+    }
+    if (pos + 1 < inner.count)
+    {
+      const index_type right = inner.child[pos + 1];
+      const index_type right_count = leaves_[right].count;
+      if (count + right_count <= node_capacity)
+      {
+        move_ranges(right, 0, right_count, child, count);
+        leaves_[child].count += right_count;
+        free_leaf(right);
+        remove_child(node, pos + 1);
+        return;
+      }
+    }
+    if (pos > 0)
+    {
+      const index_type left = inner.child[pos - 1];
+      const index_type left_count = leaves_[left].count;
+      if (left_count + count <= node_capacity)
+      {
+        move_ranges(child, 0, count, left, left_count);
+        leaves_[left].count += count;
+        free_leaf(child);
+        remove_child(node, pos);
+      }
+    }
+  }
+
+  /**
+   * Free inner child pos of the inner node once it has no children, or
+   * merge it with a sibling once it is less than a quarter full.
+   */
+  void
+  rebalance_inner (index_type node, index_type pos)
+  {
+    const Inner &inner = inners_[node];
+    const index_type child = inner.child[pos];
+    const index_type count = inners_[child].count;
+    if (count == 0)
+    {
+      free_inner(child);
+      remove_child(node, pos);
+      return;
+    }
+    if (count >= min_fill)
+    {
+      return;
+    }
+    if (pos + 1 < inner.count
+        && count + inners_[inner.child[pos + 1]].count <= node_capacity)
+    {
+      merge_inner(node, pos);
+    }
+    else if (pos > 0
+             && inners_[inner.child[pos - 1]].count + count <= node_capacity)
+    {
+      merge_inner(node, pos - 1);
+    }
+  }
+
+  /**
+   * Append child pos + 1 of the inner node to child pos, pulling down the
+   * separator between them.
+   */
+  void
+  merge_inner (index_type node, index_type pos)
+  {
+    Inner &parent = inners_[node];
+    Inner &left = inners_[parent.child[pos]];
+    const index_type right_index = parent.child[pos + 1];
+    const Inner &right = inners_[right_index];
+    const index_type count = left.count;
+    left.lb[count - 1] = parent.lb[pos];
+    left.kinds[count - 1] = parent.kinds[pos];
+    std::copy(right.lb, right.lb + right.count - 1, left.lb + count);
+    std::copy(right.kinds, right.kinds + right.count - 1, left.kinds + count);
+    std::copy(right.child, right.child + right.count, left.child + count);
+    left.count += right.count;
+    free_inner(right_index);
+    remove_child(node, pos + 1);
+  }
+
+  template<bool IsConst>
+  class basic_iterator
+  {
+    using tree_type = typename std::conditional<IsConst, const RangeBTree,
+                                                RangeBTree>::type;
+    using value_ref = typename std::conditional<IsConst, const V &,
+                                                V &>::type;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const NumericRange<T>, V>;
+    using difference_type = std::ptrdiff_t;
+    // Keys are stored as separate bounds, so they are returned by value
+    using reference = std::pair<const NumericRange<T>, value_ref>;
+
+    /**
+     * Returned by operator-> so that it->first and it->second work even
+     * though keys are rebuilt from their bounds.
+     */
+    class pointer
+    {
+    public:
+      explicit pointer (reference ref) : ref_(ref) {}
+      const reference *operator-> () const { return &ref_; }
+
+    private:
+      reference ref_;
+    };
+
+    basic_iterator () = default;
+
+    // Allow iterator -> const_iterator conversion
+    template<bool WasConst, typename = typename std::enable_if<
+        IsConst && !WasConst>::type>
+    basic_iterator (const basic_iterator<WasConst> &other) :
+        tree_(other.tree_), slot_(other.slot_)
+    {}
+
+    reference
+    operator* () const
+    {
+      return reference(tree_->key_at(slot_),
+                       tree_->leaves_[slot_.leaf].values[slot_.pos]);
+    }
+
+    pointer operator-> () const { return pointer(**this); }
+
+    basic_iterator &
+    operator++ ()
+    {
+      const Leaf &leaf = tree_->leaves_[slot_.leaf];
+      if (++slot_.pos == leaf.count)
+      {
+        slot_ = {leaf.next, 0};
+      }
+      return *this;
+    }
+
+    basic_iterator &
+    operator-- ()
+    {
+      if (slot_.leaf == none)
+      {
+        slot_.leaf = tree_->last_leaf_;
+        slot_.pos = tree_->leaves_[slot_.leaf].count;
+      }
+      else if (slot_.pos == 0)
+      {
+        slot_.leaf = tree_->leaves_[slot_.leaf].prev;
+        slot_.pos = tree_->leaves_[slot_.leaf].count;
+      }
+      --slot_.pos;
+      return *this;
+    }
+
+    basic_iterator operator++ (int) { auto tmp = *this; ++*this; return tmp; }
+    basic_iterator operator-- (int) { auto tmp = *this; --*this; return tmp; }
+
+    bool
+    operator== (const basic_iterator &other) const
+    {
+      return tree_ == other.tree_ && slot_.leaf == other.slot_.leaf
+             && slot_.pos == other.slot_.pos;
+    }
+
+    bool
+    operator!= (const basic_iterator &other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    friend class RangeBTree;
+    friend class basic_iterator<!IsConst>;
+
+    basic_iterator (tree_type *tree, Slot slot) : tree_(tree), slot_(slot) {}
+
+    tree_type *tree_ = nullptr;
+    Slot slot_{none, 0};
+  }; /* class basic_iterator */
+}; /* class RangeBTree */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_BTREE_HPP
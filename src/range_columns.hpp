@@ -0,0 +1,387 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Structure-of-arrays storage for NumericRange sequences. Bounds live in two
+ * contiguous arrays and the inclusive attributes in two bitsets, so a
+ * NumericRange<double> costs 16 bytes and 2 bits instead of 24 bytes.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_COLUMNS_HPP
+#define NUMERIC_RANGE_RANGE_COLUMNS_HPP
+
+#include "cache_utils.hpp"
+#include "numeric_range.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A sequence of NumericRange<T> stored column by column: lbs(), ubs() and
+ * one bit per range for each of lb_inclusive and ub_inclusive. Elements are
+ * read and written as whole NumericRange<T> values through operator[],
+ * set() and the random access iterators, and the columns can be scanned
+ * directly.
+ * find() requires the sequence to be sorted by NumericRangeComparator and
+ * non-overlapping, as std::lower_bound requires a sorted range.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ */
+template<typename T>
+class RangeColumns
+{
+  class proxy;
+
+public:
+  using value_type = NumericRange<T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = proxy;
+  using const_reference = NumericRange<T>;
+  class const_iterator;
+  using iterator = const_iterator;
+
+  /// Returned by find when no range contains the value.
+  static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+  RangeColumns () = default;
+
+  template<typename InputIt>
+  RangeColumns (InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      reserve(size_type(std::distance(first, last)));
+    }
+    for (; first != last; ++first)
+    {
+      push_back(*first);
+    }
+  }
+
+  explicit RangeColumns (const std::vector<NumericRange<T> > &ranges) :
+      RangeColumns(ranges.begin(), ranges.end())
+  {}
+
+  void
+  push_back (const NumericRange<T> &range)
+  {
+    const size_type pos = lb_.size();
+    if (pos % word_bits == 0)
+    {
+      lb_inclusive_.push_back(0);
+      ub_inclusive_.push_back(0);
+    }
+    lb_.push_back(range.lb);
+    ub_.push_back(range.ub);
+    set_bit(lb_inclusive_, pos, range.lb_inclusive);
+    set_bit(ub_inclusive_, pos, range.ub_inclusive);
+  }
+
+  void
+  pop_back ()
+  {
+    lb_.pop_back();
+    ub_.pop_back();
+    if (lb_.size() % word_bits == 0)
+    {
+      lb_inclusive_.pop_back();
+      ub_inclusive_.pop_back();
+    }
+  }
+
+  /**
+   * @param pos
+   * @return A copy of the range at pos
+   */
+  NumericRange<T>
+  operator[] (size_type pos) const
+  {
+    NumericRange<T> range(lb_[pos]);
+    range.lb_inclusive = lb_inclusive(pos);
+    range.ub = ub_[pos];
+    range.ub_inclusive = ub_inclusive(pos);
+    return range;
+  }
+
+  /**
+   * @param pos
+   * @return A proxy that converts to the range at pos and can be assigned a
+   * NumericRange<T>
+   */
+  proxy operator[] (size_type pos) { return proxy(this, pos); }
+
+  /**
+   * Replace the range at pos.
+   * @param pos
+   * @param range
+   */
+  void
+  set (size_type pos, const NumericRange<T> &range)
+  {
+    lb_[pos] = range.lb;
+    ub_[pos] = range.ub;
+    set_bit(lb_inclusive_, pos, range.lb_inclusive);
+    set_bit(ub_inclusive_, pos, range.ub_inclusive);
+  }
+
+  bool
+  lb_inclusive (size_type pos) const
+  {
+    return (lb_inclusive_[pos / word_bits] >> (pos % word_bits)) & 1;
+  }
+
+  bool
+  ub_inclusive (size_type pos) const
+  {
+    return (ub_inclusive_[pos / word_bits] >> (pos % word_bits)) & 1;
+  }
+
+  /**
+   * @return Contiguous array of size() lower bounds
+   */
+  const T *lbs () const { return lb_.data(); }
+
+  /**
+   * @return Contiguous array of size() upper bounds
+   */
+  const T *ubs () const { return ub_.data(); }
+
+  /**
+   * Find the range containing the scalar x, with the semantics of
+   * NumericRangeComparator. The search reads only the lower bound column
+   * and its bitset, then one upper bound.
+   * @param x
+   * @return Position of the containing range, or npos
+   */
+  size_type
+  find (const T &x) const
+  {
+    const size_type size = lb_.size();
+    const size_type pos = detail::find_in_columns(
+        lb_.data(), ub_.data(), size, x,
+        [this] (size_type i) { return lb_inclusive(i); },
+        [this] (size_type i) { return ub_inclusive(i); });
+    return pos == size ? npos : pos;
+  }
+
+  bool
+  contains (const T &x) const
+  {
+    return find(x) != npos;
+  }
+
+  const_iterator begin () const { return const_iterator(this, 0); }
+  const_iterator end () const { return const_iterator(this, size()); }
+
+  size_type size () const { return lb_.size(); }
+  bool empty () const { return lb_.empty(); }
+
+  void
+  reserve (size_type n)
+  {
+    lb_.reserve(n);
+    ub_.reserve(n);
+    lb_inclusive_.reserve((n + word_bits - 1) / word_bits);
+    ub_inclusive_.reserve((n + word_bits - 1) / word_bits);
+  }
+
+  void
+  clear ()
+  {
+    lb_.clear();
+    ub_.clear();
+    lb_inclusive_.clear();
+    ub_inclusive_.clear();
+  }
+
+  /**
+   * @return Bytes of heap storage used by the columns
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return (lb_.capacity() + ub_.capacity()) * sizeof(T)
+           + (lb_inclusive_.capacity() + ub_inclusive_.capacity())
+             * sizeof(std::uint64_t);
+  }
+
+  /**
+   * Random access iterator yielding NumericRange<T> values.
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = NumericRange<T>;
+    using difference_type = std::ptrdiff_t;
+    using reference = NumericRange<T>;
+
+    /**
+     * Returned by operator-> so that it->lb works although no
+     * NumericRange<T> object is stored.
+     */
+    class pointer
+    {
+    public:
+      explicit pointer (const NumericRange<T> &range) : range_(range) {}
+      const NumericRange<T> *operator-> () const { return &range_; }
+
+    private:
+      NumericRange<T> range_;
+    };
+
+    const_iterator () = default;
+
+    reference operator* () const { return (*columns_)[pos_]; }
+    pointer operator-> () const { return pointer(**this); }
+    reference operator[] (difference_type n) const { return *(*this + n); }
+
+    const_iterator &operator++ () { ++pos_; return *this; }
+    const_iterator &operator-- () { --pos_; return *this; }
+    const_iterator operator++ (int) { auto tmp = *this; ++pos_; return tmp; }
+    const_iterator operator-- (int) { auto tmp = *this; --pos_; return tmp; }
+
+    const_iterator &
+    operator+= (difference_type n)
+    {
+      pos_ = size_type(difference_type(pos_) + n);
+      return *this;
+    }
+
+    const_iterator &operator-= (difference_type n) { return *this += -n; }
+
+    friend const_iterator
+    operator+ (const_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+
+    friend const_iterator
+    operator+ (difference_type n, const_iterator it)
+    {
+      return it += n;
+    }
+
+    friend const_iterator
+    operator- (const_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+
+    friend difference_type
+    operator- (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return difference_type(lhs.pos_) - difference_type(rhs.pos_);
+    }
+
+    friend bool
+    operator== (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.pos_ == rhs.pos_;
+    }
+
+    friend bool
+    operator!= (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.pos_ != rhs.pos_;
+    }
+
+    friend bool
+    operator< (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return lhs.pos_ < rhs.pos_;
+    }
+
+    friend bool
+    operator> (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return rhs < lhs;
+    }
+
+    friend bool
+    operator<= (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return !(rhs < lhs);
+    }
+
+    friend bool
+    operator>= (const const_iterator &lhs, const const_iterator &rhs)
+    {
+      return !(lhs < rhs);
+    }
+
+  private:
+    friend class RangeColumns;
+
+    const RangeColumns *columns_ = nullptr;
+    size_type pos_ = 0;
+
+    const_iterator (const RangeColumns *columns, size_type pos) :
+        columns_(columns), pos_(pos)
+    {}
+  }; /* class const_iterator */
+
+private:
+  static constexpr size_type word_bits = 64;
+
+  detail::aligned_vector<T> lb_;
+  detail::aligned_vector<T> ub_;
+  std::vector<std::uint64_t> lb_inclusive_;
+  std::vector<std::uint64_t> ub_inclusive_;
+
+  static void
+  set_bit (std::vector<std::uint64_t> &bits, size_type pos, bool value)
+  {
+    const std::uint64_t mask = std::uint64_t(1) << (pos % word_bits);
+    std::uint64_t &word = bits[pos / word_bits];
+    word = value ? (word | mask) : (word & ~mask);
+  }
+
+  /**
+   * Stands in for a NumericRange<T>& to an element.
+   */
+  class proxy
+  {
+  public:
+    operator NumericRange<T> () const
+    {
+      return static_cast<const RangeColumns &>(*columns_)[pos_];
+    }
+
+    proxy &
+    operator= (const NumericRange<T> &range)
+    {
+      columns_->set(pos_, range);
+      return *this;
+    }
+
+    proxy &
+    operator= (const proxy &other)
+    {
+      return *this = NumericRange<T>(other);
+    }
+
+  private:
+    friend class RangeColumns;
+
+    RangeColumns *columns_;
+    size_type pos_;
+
+    proxy (RangeColumns *columns, size_type pos) :
+        columns_(columns), pos_(pos)
+    {}
+  }; /* class proxy */
+}; /* class RangeColumns */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_COLUMNS_HPP
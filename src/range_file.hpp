@@ -0,0 +1,496 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A binary file format for sorted, non-overlapping ranges and fixed-size
+ * values, designed to be memory-mapped and queried in place. Loading a
+ * table is then a single mmap instead of parsing and rebuilding it.
+ * Requires a POSIX system.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_FILE_HPP
+#define NUMERIC_RANGE_RANGE_FILE_HPP
+
+#include "cache_utils.hpp"
+#include "numeric_range.hpp"
+#include "range_map.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace numeric_range {
+
+/**
+ * Identifies the bound type T of a range file.
+ */
+enum class BoundType : std::uint8_t
+{
+  int8 = 1,
+  uint8,
+  int16,
+  uint16,
+  int32,
+  uint32,
+  int64,
+  uint64,
+  float32,
+  float64
+};
+
+namespace detail {
+
+template<typename T>
+constexpr BoundType
+bound_type_of ()
+{
+  static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value,
+                "Range files require an arithmetic bound type");
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8,
+                  "Range files support float and double bounds");
+    return sizeof(T) == 4 ? BoundType::float32 : BoundType::float64;
+  }
+  else
+  {
+    static_assert(sizeof(T) <= 8, "Range files support up to 64-bit bounds");
+    constexpr bool is_signed = std::is_signed<T>::value;
+    switch (sizeof(T))
+    {
+      case 1:
+        return is_signed ? BoundType::int8 : BoundType::uint8;
+      case 2:
+        return is_signed ? BoundType::int16 : BoundType::uint16;
+      case 4:
+        return is_signed ? BoundType::int32 : BoundType::uint32;
+      default:
+        return is_signed ? BoundType::int64 : BoundType::uint64;
+    }
+  }
+}
+
+/**
+ * Fixed-size file header. All fields are in the byte order of the machine
+ * that wrote the file; byte_order detects files from the other order.
+ */
+struct RangeFileHeader
+{
+  char magic[8];
+  std::uint32_t byte_order;
+  std::uint32_t version;
+  BoundType bound_type;
+  // Encoding of the inclusive flags; see range_file_flags
+  std::uint8_t flag_encoding;
+  std::uint16_t reserved;
+  std::uint32_t value_size;
+  std::uint64_t count;
+  // Byte offsets of the arrays from the start of the file
+  std::uint64_t lb_offset;
+  std::uint64_t ub_offset;
+  std::uint64_t flags_offset;
+  std::uint64_t values_offset;
+  std::uint64_t file_size;
+  // checksum64 of every byte after the header
+  std::uint64_t checksum;
+};
+
+static_assert(sizeof(RangeFileHeader) == 80, "Unexpected header padding");
+
+constexpr char range_file_magic[8] = {'N', 'R', 'A', 'N', 'G', 'E', 'S', '\0'};
+constexpr std::uint32_t range_file_byte_order = 0x01020304;
+constexpr std::uint32_t range_file_version = 1;
+
+// One byte per range: bit 0 is lb_inclusive, bit 1 is ub_inclusive.
+constexpr std::uint8_t range_file_flags = 1;
+
+/**
+ * A fast, non-cryptographic 64-bit checksum that consumes eight bytes per
+ * step, to detect truncated or corrupted files.
+ */
+inline std::uint64_t
+checksum64 (const unsigned char *data, std::size_t size)
+{
+  std::uint64_t h = 0x9E3779B97F4A7C15ull ^ size;
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, 8);
+    h = (h ^ word) * 0xFF51AFD7ED558CCDull;
+    h ^= h >> 32;
+  }
+  for (; i < size; ++i)
+  {
+    h = (h ^ data[i]) * 0x100000001B3ull;
+  }
+  return h ^ (h >> 29);
+}
+
+/**
+ * Write all size bytes of data to fd, retrying short and interrupted writes.
+ * @return Whether every byte was written
+ */
+inline bool
+write_all (int fd, const void *data, std::size_t size)
+{
+  const char *p = static_cast<const char *>(data);
+  while (size != 0)
+  {
+    const ssize_t written = ::write(fd, p, size);
+    if (written < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    p += written;
+    size -= std::size_t(written);
+  }
+  return true;
+}
+
+inline std::uint64_t
+align_offset (std::uint64_t offset)
+{
+  return (offset + cache_line_size - 1) / cache_line_size * cache_line_size;
+}
+
+} /* namespace detail */
+
+/**
+ * Write ranges and their values to a file that MappedRangeFile can map.
+ * The file is written to a temporary sibling, synced and renamed over path,
+ * so that processes which still map the previous file keep a complete view
+ * of it. The layout is a header followed by cache-line-aligned arrays of lower
+ * bounds, upper bounds, flags and values, in structure-of-arrays form so
+ * that searches touch only the lower bounds and their flags.
+ * @tparam T An integer of up to 64 bits, float or double
+ * @tparam V A trivially copyable value type
+ * @param path
+ * @param ranges Sorted by NumericRangeComparator and non-overlapping
+ * @param values Value of ranges[i] at position i
+ * @throws invalid_argument If ranges and values differ in size
+ * @throws runtime_error If ranges are unsorted or overlap, or the file
+ * cannot be written
+ */
+template<typename T, typename V>
+void
+write_range_file (const std::string &path,
+                  const std::vector<NumericRange<T> > &ranges,
+                  const std::vector<V> &values)
+{
+  static_assert(std::is_trivially_copyable<V>::value,
+                "Range file values must be trivially copyable");
+  if (ranges.size() != values.size())
+  {
+    NUMERIC_RANGE_THROW(std::invalid_argument(
+        "Ranges and values must have the same size"));
+  }
+  detail::check_disjoint_sorted(ranges.begin(), ranges.end());
+
+  const std::uint64_t n = ranges.size();
+  detail::RangeFileHeader header{};
+  std::memcpy(header.magic, detail::range_file_magic, sizeof(header.magic));
+  header.byte_order = detail::range_file_byte_order;
+  header.version = detail::range_file_version;
+  header.bound_type = detail::bound_type_of<T>();
+  header.flag_encoding = detail::range_file_flags;
+  header.value_size = sizeof(V);
+  header.count = n;
+  header.lb_offset = detail::align_offset(sizeof(header));
+  header.ub_offset = detail::align_offset(header.lb_offset + n * sizeof(T));
+  header.flags_offset = detail::align_offset(header.ub_offset + n * sizeof(T));
+  header.values_offset = detail::align_offset(header.flags_offset + n);
+  header.file_size = header.values_offset + n * sizeof(V);
+
+  std::vector<unsigned char> payload(header.file_size - sizeof(header));
+  const auto at = [&payload] (std::uint64_t offset) {
+    return payload.data() + (offset - sizeof(detail::RangeFileHeader));
+  };
+  unsigned char *lbs = at(header.lb_offset);
+  unsigned char *ubs = at(header.ub_offset);
+  unsigned char *flags = at(header.flags_offset);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    std::memcpy(lbs + i * sizeof(T), &ranges[i].lb, sizeof(T));
+    std::memcpy(ubs + i * sizeof(T), &ranges[i].ub, sizeof(T));
+    flags[i] = std::uint8_t((ranges[i].lb_inclusive ? 1 : 0)
+                            | (ranges[i].ub_inclusive ? 2 : 0));
+  }
+  if (n != 0)
+  {
+    std::memcpy(at(header.values_offset), values.data(), n * sizeof(V));
+  }
+  header.checksum = detail::checksum64(payload.data(), payload.size());
+
+  // Readers may have the old file mapped, so it is replaced by a rename
+  // instead of being rewritten in place
+  const std::string temp = path + ".tmp." + std::to_string(::getpid());
+  const int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+  {
+    NUMERIC_RANGE_THROW(std::runtime_error("Cannot write " + path));
+  }
+  bool ok = detail::write_all(fd, &header, sizeof(header))
+            && detail::write_all(fd, payload.data(), payload.size())
+            && ::fsync(fd) == 0;
+  ok = ::close(fd) == 0 && ok;
+  if (!ok || ::rename(temp.c_str(), path.c_str()) != 0)
+  {
+    ::unlink(temp.c_str());
+    NUMERIC_RANGE_THROW(std::runtime_error("Cannot write " + path));
+  }
+}
+
+template<typename T, typename V>
+void
+write_range_file (const std::string &path, const RangeMap<T, V> &map)
+{
+  write_range_file(path, map.keys(), map.values());
+}
+
+/**
+ * A read-only view of a range file mapped into memory. Lookups binary
+ * search the mapped lower bounds directly, so opening a file costs one
+ * mmap regardless of its size, and pages are loaded on demand by the
+ * operating system. Verifying the checksum is opt-in, since it reads the
+ * whole file.
+ * @tparam T Bound type the file was written with
+ * @tparam V Value type the file was written with
+ */
+template<typename T, typename V>
+class MappedRangeFile
+{
+  static_assert(std::is_trivially_copyable<V>::value,
+                "Range file values must be trivially copyable");
+
+public:
+  using size_type = std::size_t;
+
+  /// Returned by find_index when no range contains the value.
+  static constexpr size_type npos = ~size_type(0);
+
+  /**
+   * Map the file at path and validate its header.
+   * @param path
+   * @param verify_checksum Whether to read the whole file once to verify
+   * its checksum. The header, types and sizes are always validated.
+   * @throws runtime_error If the file cannot be mapped, is not a range file
+   * for T and V, is truncated, or fails a requested checksum verification
+   */
+  explicit MappedRangeFile (const std::string &path,
+                            bool verify_checksum = false)
+  {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error("Cannot open " + path));
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0)
+    {
+      ::close(fd);
+      NUMERIC_RANGE_THROW(std::runtime_error("Cannot stat " + path));
+    }
+    size_ = std::size_t(st.st_size);
+    if (size_ < sizeof(detail::RangeFileHeader))
+    {
+      ::close(fd);
+      NUMERIC_RANGE_THROW(std::runtime_error("Not a range file: " + path));
+    }
+    void *data = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error("Cannot map " + path));
+    }
+    data_ = static_cast<const unsigned char *>(data);
+
+    const char *error = validate(verify_checksum);
+    if (error != nullptr)
+    {
+      unmap();
+      NUMERIC_RANGE_THROW(std::runtime_error(std::string(error) + ": " + path));
+    }
+  }
+
+  MappedRangeFile (MappedRangeFile &&other) noexcept
+  {
+    *this = std::move(other);
+  }
+
+  MappedRangeFile &
+  operator= (MappedRangeFile &&other) noexcept
+  {
+    if (this != &other)
+    {
+      unmap();
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+      n_ = std::exchange(other.n_, 0);
+      lb_ = other.lb_;
+      ub_ = other.ub_;
+      flags_ = other.flags_;
+      values_ = other.values_;
+    }
+    return *this;
+  }
+
+  MappedRangeFile (const MappedRangeFile &) = delete;
+  MappedRangeFile &operator= (const MappedRangeFile &) = delete;
+
+  ~MappedRangeFile () { unmap(); }
+
+  /**
+   * Find the range containing the scalar x, with the semantics of
+   * NumericRangeComparator.
+   * @param x
+   * @return Position of the containing range, or npos
+   */
+  size_type
+  find_index (const T x) const
+  {
+    const std::uint8_t *flags = flags_;
+    const size_type pos = detail::find_in_columns(
+        lb_, ub_, n_, x, [flags] (size_type i) { return (flags[i] & 1) != 0; },
+        [flags] (size_type i) { return (flags[i] & 2) != 0; });
+    return pos == n_ ? npos : pos;
+  }
+
+  /**
+   * @param x
+   * @return Pointer to the value of the range containing x, or nullptr
+   */
+  const V *
+  find (const T x) const
+  {
+    const size_type pos = find_index(x);
+    return pos == npos ? nullptr : values_ + pos;
+  }
+
+  bool
+  contains (const T x) const
+  {
+    return find_index(x) != npos;
+  }
+
+  /**
+   * @param pos
+   * @return The range at position pos
+   */
+  NumericRange<T>
+  range (size_type pos) const
+  {
+    NumericRange<T> r(lb_[pos]);
+    r.lb_inclusive = flags_[pos] & 1;
+    r.ub = ub_[pos];
+    r.ub_inclusive = (flags_[pos] & 2) != 0;
+    return r;
+  }
+
+  const V &value (size_type pos) const { return values_[pos]; }
+
+  size_type size () const { return n_; }
+  bool empty () const { return n_ == 0; }
+
+  /**
+   * @return Size of the mapping in bytes
+   */
+  std::size_t file_size () const { return size_; }
+
+private:
+  const unsigned char *data_ = nullptr;
+  std::size_t size_ = 0;
+  size_type n_ = 0;
+  const T *lb_ = nullptr;
+  const T *ub_ = nullptr;
+  const std::uint8_t *flags_ = nullptr;
+  const V *values_ = nullptr;
+
+  /**
+   * @return nullptr if the mapping is a valid range file, otherwise the
+   * reason it is not
+   */
+  const char *
+  validate (bool verify_checksum)
+  {
+    detail::RangeFileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, detail::range_file_magic,
+                    sizeof(header.magic)) != 0)
+    {
+      return "Not a range file";
+    }
+    if (header.byte_order != detail::range_file_byte_order)
+    {
+      return "Range file has a different byte order";
+    }
+    if (header.version != detail::range_file_version
+        || header.flag_encoding != detail::range_file_flags)
+    {
+      return "Unsupported range file version";
+    }
+    if (header.bound_type != detail::bound_type_of<T>()
+        || header.value_size != sizeof(V))
+    {
+      return "Range file has a different bound or value type";
+    }
+    const std::uint64_t n = header.count;
+    const std::uint64_t limit = size_;
+    const auto fits = [limit] (std::uint64_t offset, std::uint64_t bytes,
+                               std::uint64_t count) {
+      return offset % detail::cache_line_size == 0 && offset <= limit
+             && count <= (limit - offset) / bytes;
+    };
+    if (header.file_size != size_ || !fits(header.lb_offset, sizeof(T), n)
+        || !fits(header.ub_offset, sizeof(T), n)
+        || !fits(header.flags_offset, 1, n)
+        || !fits(header.values_offset, sizeof(V), n))
+    {
+      return "Range file is truncated";
+    }
+    if (verify_checksum
+        && detail::checksum64(data_ + sizeof(header), size_ - sizeof(header))
+           != header.checksum)
+    {
+      return "Range file checksum mismatch";
+    }
+
+    n_ = size_type(n);
+    lb_ = reinterpret_cast<const T *>(data_ + header.lb_offset);
+    ub_ = reinterpret_cast<const T *>(data_ + header.ub_offset);
+    flags_ = data_ + header.flags_offset;
+    values_ = reinterpret_cast<const V *>(data_ + header.values_offset);
+    return nullptr;
+  }
+
+  void
+  unmap ()
+  {
+    if (data_ != nullptr)
+    {
+      ::munmap(const_cast<unsigned char *>(data_), size_);
+      data_ = nullptr;
+    }
+  }
+}; /* class MappedRangeFile */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_FILE_HPP
@@ -0,0 +1,477 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A flat, sorted associative container mapping non-overlapping NumericRange
+ * keys to values. Keys and values are kept in two contiguous arrays sorted
+ * by NumericRangeComparator, so scalar lookups are a binary search over
+ * adjacent memory instead of a walk over heap-allocated tree nodes.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_MAP_HPP
+#define NUMERIC_RANGE_RANGE_MAP_HPP
+
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A RangeMap is a drop-in alternative to
+ * std::map<NumericRange<T>, V, NumericRangeComparator<T> > for workloads
+ * that are dominated by lookups. Ranges are stored in sorted order in one
+ * contiguous array and their values in a parallel array.
+ * Insertion and erasure are O(n) due to shifting elements, lookups are
+ * O(log n) and touch far fewer cache lines than a red-black tree.
+ * Like std::map with NumericRangeComparator, inserting a range that overlaps
+ * an existing one throws a runtime_error.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam V Mapped value type.
+ */
+template<typename T, typename V>
+class RangeMap
+{
+  template<bool IsConst>
+  class basic_iterator;
+
+public:
+  using key_type = NumericRange<T>;
+  using mapped_type = V;
+  using key_compare = NumericRangeComparator<T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  /**
+   * Result of try_insert. On success, or if an equivalent key exists,
+   * position refers to that element. On overlap it refers to the first
+   * element that conflicts with the range being inserted.
+   */
+  struct insert_result
+  {
+    iterator position;
+    InsertStatus status;
+  };
+
+  RangeMap () = default;
+
+  /**
+   * Bulk-load the map from keys sorted by NumericRangeComparator and their
+   * values, taking ownership of both arrays without copying them. The keys
+   * are validated in one linear pass.
+   * @param keys
+   * @param values Value of keys[i] at position i
+   * @throws invalid_argument If keys and values differ in size
+   * @throws runtime_error If keys overlap or are not strictly sorted, naming
+   * the first offending pair
+   */
+  RangeMap (sorted_unique_t, std::vector<NumericRange<T> > keys,
+            std::vector<V> values) :
+      keys_(std::move(keys)), values_(std::move(values))
+  {
+    if (keys_.size() != values_.size())
+    {
+      NUMERIC_RANGE_THROW(std::invalid_argument(
+          "Keys and values must have the same size"));
+    }
+    detail::check_disjoint_sorted(keys_.begin(), keys_.end());
+  }
+
+  /**
+   * Bulk-load the map from a sequence of (range, value) pairs sorted by
+   * range. For forward iterators each array is allocated exactly once.
+   * @param first
+   * @param last
+   * @throws runtime_error If the ranges overlap or are not strictly sorted,
+   * naming the first offending pair
+   */
+  template<typename InputIt>
+  RangeMap (sorted_unique_t, InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category>::value)
+    {
+      reserve(size_type(std::distance(first, last)));
+    }
+    for (; first != last; ++first)
+    {
+      keys_.push_back(first->first);
+      values_.push_back(first->second);
+    }
+    detail::check_disjoint_sorted(keys_.begin(), keys_.end());
+  }
+
+  /**
+   * Insert a range and its value, keeping the map sorted.
+   * If an equivalent key already exists (the same range, or a range
+   * containing the scalar being inserted), nothing is inserted.
+   * @param range
+   * @param value
+   * @return Iterator to the inserted or existing element, and whether the
+   * insertion took place
+   * @throws runtime_error If range overlaps a range already in the map
+   */
+  std::pair<iterator, bool>
+  insert (const NumericRange<T> &range, const V &value)
+  {
+    return checked_insert(try_insert(range, value));
+  }
+
+  std::pair<iterator, bool>
+  insert (const NumericRange<T> &range, V &&value)
+  {
+    return checked_insert(try_insert(range, std::move(value)));
+  }
+
+  std::pair<iterator, bool>
+  insert (const std::pair<NumericRange<T>, V> &kv)
+  {
+    return checked_insert(try_insert(kv.first, kv.second));
+  }
+
+  /**
+   * Insert a range and its value, reporting conflicts through the return
+   * value instead of throwing. Suitable for builds without exceptions and
+   * for hot paths where overlaps are expected.
+   * @param range
+   * @param value
+   * @return The outcome of the insertion and the affected element
+   */
+  template<typename U>
+  insert_result
+  try_insert (const NumericRange<T> &range, U &&value)
+  {
+    const size_type pos = lower_bound_index(range);
+    if (pos < keys_.size())
+    {
+      switch (key_compare().compare(range, keys_[pos]))
+      {
+        case RangeOrdering::less:
+          break;
+        case RangeOrdering::overlap:
+          return {iterator(this, pos), InsertStatus::overlap};
+        default:
+          return {iterator(this, pos), InsertStatus::exists};
+      }
+    }
+
+    keys_.insert(keys_.begin() + difference_type(pos), range);
+    values_.insert(values_.begin() + difference_type(pos),
+                   std::forward<U>(value));
+    return {iterator(this, pos), InsertStatus::inserted};
+  }
+
+  /**
+   * Erase the element whose key is equivalent to range.
+   * @param range
+   * @return Number of elements erased (0 or 1)
+   * @throws runtime_error If range overlaps but is not equivalent to a key
+   */
+  size_type
+  erase (const NumericRange<T> &range)
+  {
+    const size_type pos = find_equivalent_index(range);
+    if (pos == keys_.size())
+    {
+      return 0;
+    }
+    erase_at(pos);
+    return 1;
+  }
+
+  /**
+   * Erase the element at pos.
+   * @param pos Must be a valid, dereferenceable iterator into this map
+   * @return Iterator following the erased element
+   */
+  iterator
+  erase (const_iterator pos)
+  {
+    erase_at(pos.pos_);
+    return iterator(this, pos.pos_);
+  }
+
+  /**
+   * Find the range containing the scalar x.
+   * @param x
+   * @return Iterator to the containing element, or end() if none
+   */
+  iterator
+  find (const T &x)
+  {
+    return iterator(this, find_index(x));
+  }
+
+  const_iterator
+  find (const T &x) const
+  {
+    return const_iterator(this, find_index(x));
+  }
+
+  /**
+   * Find the element equivalent to range under NumericRangeComparator, i.e.
+   * the same range or, if range is a scalar, the range containing it.
+   * @param range
+   * @return Iterator to the equivalent element, or end() if none
+   * @throws runtime_error If range overlaps but is not equivalent to a key
+   */
+  iterator
+  find (const NumericRange<T> &range)
+  {
+    return iterator(this, find_equivalent_index(range));
+  }
+
+  const_iterator
+  find (const NumericRange<T> &range) const
+  {
+    return const_iterator(this, find_equivalent_index(range));
+  }
+
+  bool
+  contains (const T &x) const
+  {
+    return find_index(x) != keys_.size();
+  }
+
+  /**
+   * Access the value mapped to the range containing x.
+   * @param x
+   * @return Reference to the mapped value
+   * @throws out_of_range If no range contains x
+   */
+  V &
+  at (const T &x)
+  {
+    return values_[checked_find_index(x)];
+  }
+
+  const V &
+  at (const T &x) const
+  {
+    return values_[checked_find_index(x)];
+  }
+
+  iterator begin () { return iterator(this, 0); }
+  iterator end () { return iterator(this, keys_.size()); }
+  const_iterator begin () const { return const_iterator(this, 0); }
+  const_iterator end () const { return const_iterator(this, keys_.size()); }
+  const_iterator cbegin () const { return begin(); }
+  const_iterator cend () const { return end(); }
+
+  size_type size () const { return keys_.size(); }
+  bool empty () const { return keys_.empty(); }
+
+  void
+  clear ()
+  {
+    keys_.clear();
+    values_.clear();
+  }
+
+  void
+  reserve (size_type n)
+  {
+    keys_.reserve(n);
+    values_.reserve(n);
+  }
+
+  /**
+   * @return The sorted, contiguous array of keys.
+   */
+  const std::vector<NumericRange<T> > &keys () const { return keys_; }
+
+  /**
+   * @return The values, in the same order as keys().
+   */
+  const std::vector<V> &values () const { return values_; }
+
+private:
+  std::vector<NumericRange<T> > keys_;
+  std::vector<V> values_;
+
+  std::pair<iterator, bool>
+  checked_insert (const insert_result &result)
+  {
+    if (result.status == InsertStatus::overlap)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Invalid comparison between overlapping ranges"));
+    }
+    return {result.position, result.status == InsertStatus::inserted};
+  }
+
+  void
+  erase_at (size_type pos)
+  {
+    keys_.erase(keys_.begin() + difference_type(pos));
+    values_.erase(values_.begin() + difference_type(pos));
+  }
+
+  /**
+   * Index of the first key that is not entirely before range. Every key
+   * before it is less than range, so only this key can be equivalent to or
+   * overlap range. Never throws.
+   */
+  size_type
+  lower_bound_index (const NumericRange<T> &range) const
+  {
+    const key_compare comp;
+    return size_type(std::partition_point(
+        keys_.begin(), keys_.end(),
+        [&comp, &range] (const NumericRange<T> &key) {
+          return comp.compare(key, range) == RangeOrdering::less;
+        }) - keys_.begin());
+  }
+
+  /**
+   * @return Index of the key equivalent to range, or size() if none
+   * @throws runtime_error If range overlaps a key
+   */
+  size_type
+  find_equivalent_index (const NumericRange<T> &range) const
+  {
+    const size_type pos = lower_bound_index(range);
+    if (pos == keys_.size())
+    {
+      return pos;
+    }
+    switch (key_compare().compare(range, keys_[pos]))
+    {
+      case RangeOrdering::less:
+        return keys_.size();
+      case RangeOrdering::overlap:
+        NUMERIC_RANGE_THROW(std::runtime_error(
+            "Invalid comparison between overlapping ranges"));
+      default:
+        return pos;
+    }
+  }
+
+  size_type
+  checked_find_index (const T &x) const
+  {
+    const size_type pos = find_index(x);
+    if (pos == keys_.size())
+    {
+      NUMERIC_RANGE_THROW(std::out_of_range(
+          "No range contains the given value"));
+    }
+    return pos;
+  }
+
+  /**
+   * Branch-free binary search for the first range that is not entirely
+   * before x, followed by a check that x is not entirely before that range.
+   * Uses the heterogeneous overloads of NumericRangeComparator, so the
+   * semantics are those of comparing NumericRange{x} against each key.
+   */
+  size_type
+  find_index (const T &x) const
+  {
+    const key_compare comp;
+    const NumericRange<T> *base = keys_.data();
+    size_type n = keys_.size();
+    if (n == 0)
+    {
+      return 0;
+    }
+    while (n > 1)
+    {
+      const size_type half = n / 2;
+      base = comp(base[half - 1], x) ? base + half : base;
+      n -= half;
+    }
+    // NaN is never contained in a range
+    if (comp(*base, x) || comp(x, *base) || x != x)
+    {
+      return keys_.size();
+    }
+    return size_type(base - keys_.data());
+  }
+
+  template<bool IsConst>
+  class basic_iterator
+  {
+    using map_type = typename std::conditional<IsConst, const RangeMap,
+                                               RangeMap>::type;
+    using value_ref = typename std::conditional<IsConst, const V &,
+                                                V &>::type;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const NumericRange<T>, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const NumericRange<T> &, value_ref>;
+
+    /**
+     * Returned by operator-> so that it->first and it->second work even
+     * though keys and values live in separate arrays.
+     */
+    class pointer
+    {
+    public:
+      explicit pointer (reference ref) : ref_(ref) {}
+      const reference *operator-> () const { return &ref_; }
+
+    private:
+      reference ref_;
+    };
+
+    basic_iterator () = default;
+
+    // Allow iterator -> const_iterator conversion
+    template<bool WasConst, typename = typename std::enable_if<
+        IsConst && !WasConst>::type>
+    basic_iterator (const basic_iterator<WasConst> &other) :
+        map_(other.map_), pos_(other.pos_)
+    {}
+
+    reference
+    operator* () const
+    {
+      return reference(map_->keys_[pos_], map_->values_[pos_]);
+    }
+
+    pointer operator-> () const { return pointer(**this); }
+
+    basic_iterator &operator++ () { ++pos_; return *this; }
+    basic_iterator &operator-- () { --pos_; return *this; }
+    basic_iterator operator++ (int) { auto tmp = *this; ++pos_; return tmp; }
+    basic_iterator operator-- (int) { auto tmp = *this; --pos_; return tmp; }
+
+    bool
+    operator== (const basic_iterator &other) const
+    {
+      return map_ == other.map_ && pos_ == other.pos_;
+    }
+
+    bool
+    operator!= (const basic_iterator &other) const
+    {
+      return !(*this == other);
+    }
+
+  private:
+    friend class RangeMap;
+    friend class basic_iterator<!IsConst>;
+
+    basic_iterator (map_type *map, size_type pos) : map_(map), pos_(pos) {}
+
+    map_type *map_ = nullptr;
+    size_type pos_ = 0;
+  }; /* class basic_iterator */
+}; /* class RangeMap */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_MAP_HPP
@@ -0,0 +1,303 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A partition of an interval of the number line into adjacent buckets, such
+ * as histogram bins or tax brackets. Adjacent buckets share a bound, so n
+ * buckets are stored as n + 1 boundary points instead of n ranges.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_PARTITION_HPP
+#define NUMERIC_RANGE_RANGE_PARTITION_HPP
+
+#include "cache_utils.hpp"
+#include "interpolation_search.hpp"
+#include "numeric_range.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * Which of the two buckets around a boundary point contains the point
+ * itself.
+ */
+enum class BoundarySide
+{
+  left,   ///< The bucket ending at the boundary, i.e. its UB is inclusive
+  right   ///< The bucket starting at the boundary, i.e. its LB is inclusive
+};
+
+/**
+ * A RangePartition maps each of n adjacent buckets to a value. Bucket i
+ * spans boundaries i and i + 1, and every boundary point belongs to exactly
+ * one side: to bucket i - 1 or to bucket i. The outermost boundaries may
+ * belong to no bucket, e.g. the first one when its side is left.
+ * Lookups are a branch-free upper bound search over the boundaries. Buckets
+ * can be split and merged in O(n).
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam V Mapped value type.
+ */
+template<typename T, typename V>
+class RangePartition
+{
+public:
+  using size_type = std::size_t;
+
+  /// Returned by find_index when no bucket contains the value.
+  static constexpr size_type npos = std::numeric_limits<size_type>::max();
+
+  RangePartition () = default;
+
+  /**
+   * Build a partition from adjacent ranges and their values. Each range
+   * must start at the upper bound of its predecessor, with exactly one of
+   * the two sharing the bound inclusively.
+   * @param ranges
+   * @param values
+   * @throws runtime_error If two consecutive ranges are not adjacent, naming
+   * their positions
+   * @throws invalid_argument If ranges and values differ in size
+   */
+  RangePartition (const std::vector<NumericRange<T> > &ranges,
+                  std::vector<V> values) :
+      values_(std::move(values))
+  {
+    if (ranges.size() != values_.size())
+    {
+      NUMERIC_RANGE_THROW(std::invalid_argument(
+          "RangePartition requires one value per range"));
+    }
+    if (ranges.empty())
+    {
+      return;
+    }
+    bounds_.reserve(ranges.size() + 1);
+    sides_.reserve(ranges.size() + 1);
+    for (size_type i = 0; i < ranges.size(); ++i)
+    {
+      const NumericRange<T> &range = ranges[i];
+      if (i > 0)
+      {
+        const NumericRange<T> &prev = ranges[i - 1];
+        if (!(prev.ub == range.lb) || prev.ub_inclusive == range.lb_inclusive)
+        {
+          NUMERIC_RANGE_THROW(std::runtime_error(
+              "Ranges must be adjacent: positions " + std::to_string(i - 1)
+              + " and " + std::to_string(i)));
+        }
+      }
+      bounds_.push_back(range.lb);
+      sides_.push_back(std::uint8_t(range.lb_inclusive));
+    }
+    bounds_.push_back(ranges.back().ub);
+    sides_.push_back(std::uint8_t(!ranges.back().ub_inclusive));
+  }
+
+  /**
+   * Build a partition from strictly increasing boundaries, where every
+   * boundary belongs to the same side. With BoundarySide::right, bucket i
+   * is [b[i], b[i + 1]) and the last boundary belongs to no bucket.
+   * @param boundaries n + 1 points for n buckets
+   * @param values n values
+   * @param side
+   * @throws runtime_error If boundaries are not strictly increasing
+   * @throws invalid_argument If there is not one more boundary than values
+   */
+  RangePartition (std::vector<T> boundaries, std::vector<V> values,
+                  const BoundarySide side) :
+      values_(std::move(values))
+  {
+    if (boundaries.empty() ? !values_.empty()
+                           : boundaries.size() != values_.size() + 1)
+    {
+      NUMERIC_RANGE_THROW(std::invalid_argument(
+          "RangePartition requires one more boundary than values"));
+    }
+    for (size_type i = 1; i < boundaries.size(); ++i)
+    {
+      if (!(boundaries[i - 1] < boundaries[i]))
+      {
+        NUMERIC_RANGE_THROW(std::runtime_error(
+            "Boundaries must be strictly increasing: positions "
+            + std::to_string(i - 1) + " and " + std::to_string(i)));
+      }
+    }
+    bounds_.assign(boundaries.begin(), boundaries.end());
+    sides_.assign(bounds_.size(), std::uint8_t(side == BoundarySide::right));
+  }
+
+  /**
+   * Find the bucket containing the scalar x.
+   * @param x
+   * @return Position of the bucket, or npos
+   */
+  size_type
+  find_index (const T &x) const
+  {
+    const size_type count = bounds_.size();
+    if (count == 0)
+    {
+      return npos;
+    }
+    // Last boundary <= x, i.e. upper_bound(x) - 1
+    const T *bounds = bounds_.data();
+    const size_type base = detail::last_le(bounds, 0, count, x);
+    // NaN and values below the first boundary end up here as well
+    if (!(bounds[base] <= x))
+    {
+      return npos;
+    }
+    // A boundary on the left side belongs to the previous bucket. Below
+    // bucket 0 this wraps around to npos.
+    const bool left = (x == bounds[base]) & (sides_[base] == 0);
+    const size_type bucket = base - size_type(left);
+    return bucket < count - 1 ? bucket : npos;
+  }
+
+  /**
+   * @param x
+   * @return Pointer to the value of the bucket containing x, or nullptr
+   */
+  const V *
+  find (const T &x) const
+  {
+    const size_type pos = find_index(x);
+    return pos == npos ? nullptr : &values_[pos];
+  }
+
+  V *
+  find (const T &x)
+  {
+    const size_type pos = find_index(x);
+    return pos == npos ? nullptr : &values_[pos];
+  }
+
+  bool
+  contains (const T &x) const
+  {
+    return find_index(x) != npos;
+  }
+
+  /**
+   * @param pos
+   * @return Bucket pos as a range
+   */
+  NumericRange<T>
+  bucket (size_type pos) const
+  {
+    return NumericRange<T>(bounds_[pos], sides_[pos] != 0,
+                           bounds_[pos + 1], sides_[pos + 1] == 0);
+  }
+
+  const V &value (size_type pos) const { return values_[pos]; }
+  V &value (size_type pos) { return values_[pos]; }
+
+  /**
+   * @return Contiguous array of boundary_count() sorted boundaries
+   */
+  const T *boundaries () const { return bounds_.data(); }
+
+  /**
+   * @return Number of boundaries, size() + 1 unless empty
+   */
+  size_type boundary_count () const { return bounds_.size(); }
+
+  /**
+   * @param pos
+   * @return Side of boundary pos that contains the boundary point
+   */
+  BoundarySide
+  side (size_type pos) const
+  {
+    return sides_[pos] != 0 ? BoundarySide::right : BoundarySide::left;
+  }
+
+  /**
+   * Split the bucket containing at into two buckets meeting at at. The left
+   * part keeps the value of the bucket and the right part takes value.
+   * @param at
+   * @param at_side Part that contains at itself
+   * @param value
+   * @return Position of the right part
+   * @throws out_of_range If no bucket contains at
+   * @throws runtime_error If either part would be empty, e.g. when splitting
+   * [0, 1) at 0 with at on the right side
+   */
+  size_type
+  split (const T &at, const BoundarySide at_side, V value)
+  {
+    const size_type pos = find_index(at);
+    if (pos == npos)
+    {
+      NUMERIC_RANGE_THROW(std::out_of_range(
+          "Split point lies outside the partition"));
+    }
+    const bool right = at_side == BoundarySide::right;
+    if (!NumericRange<T>::is_valid(bounds_[pos], sides_[pos] != 0, at, !right)
+        || !NumericRange<T>::is_valid(at, right, bounds_[pos + 1],
+                                      sides_[pos + 1] == 0))
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Split would leave an empty bucket"));
+    }
+    bounds_.insert(bounds_.begin() + std::ptrdiff_t(pos + 1), at);
+    sides_.insert(sides_.begin() + std::ptrdiff_t(pos + 1),
+                  std::uint8_t(right));
+    values_.insert(values_.begin() + std::ptrdiff_t(pos + 1),
+                   std::move(value));
+    return pos + 1;
+  }
+
+  /**
+   * Merge bucket pos with bucket pos + 1, keeping the value of bucket pos.
+   * @param pos
+   * @throws out_of_range If bucket pos + 1 does not exist
+   */
+  void
+  merge (size_type pos)
+  {
+    if (pos + 1 >= values_.size())
+    {
+      NUMERIC_RANGE_THROW(std::out_of_range(
+          "RangePartition::merge requires two adjacent buckets"));
+    }
+    bounds_.erase(bounds_.begin() + std::ptrdiff_t(pos + 1));
+    sides_.erase(sides_.begin() + std::ptrdiff_t(pos + 1));
+    values_.erase(values_.begin() + std::ptrdiff_t(pos + 1));
+  }
+
+  /**
+   * @return Number of buckets
+   */
+  size_type size () const { return values_.size(); }
+  bool empty () const { return values_.empty(); }
+
+  /**
+   * @return Bytes of heap storage used by the partition
+   */
+  std::size_t
+  memory_usage () const
+  {
+    return bounds_.capacity() * sizeof(T) + sides_.capacity()
+           + values_.capacity() * sizeof(V);
+  }
+
+private:
+  detail::aligned_vector<T> bounds_;
+  // 1 if the boundary point belongs to the bucket on its right
+  std::vector<std::uint8_t> sides_;
+  std::vector<V> values_;
+}; /* class RangePartition */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_PARTITION_HPP
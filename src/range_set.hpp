@@ -0,0 +1,214 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A set of values in a linear space, represented as the smallest possible
+ * number of disjoint NumericRange components. Ranges that overlap or touch
+ * are merged as they are inserted.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_SET_HPP
+#define NUMERIC_RANGE_RANGE_SET_HPP
+
+#include "numeric_range.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <type_traits>
+
+namespace numeric_range {
+
+/**
+ * A RangeSet stores the union of every range inserted into it as disjoint,
+ * non-adjacent components ordered by their lower bound. Two ranges are
+ * adjacent if no value of type T lies between them, so [0, 1) and [1, 2)
+ * merge into [0, 2) while (0, 1) and (1, 2) do not. For integral T, [0, 1]
+ * and [2, 3] also merge since there is no integer between 1 and 2.
+ * Insertion is O(log n) amortized (each component is erased at most once
+ * after being created), and membership queries are O(log n) in the number
+ * of components rather than the number of inserted ranges.
+ * @tparam T An arithmetic type.
+ */
+template<typename T>
+class RangeSet
+{
+  static_assert(std::is_arithmetic<T>::value,
+                "RangeSet requires an arithmetic type");
+
+  /**
+   * Orders components by lower bound. Components never share a lower bound
+   * so this is a strict ordering for them. A scalar x is "greater" than a
+   * component iff the component starts at or before x.
+   */
+  struct LowerBoundLess
+  {
+    using is_transparent = void;
+
+    bool
+    operator() (const NumericRange<T> &lhs, const NumericRange<T> &rhs) const
+    {
+      return (lhs.lb < rhs.lb)
+             || (lhs.lb == rhs.lb && lhs.lb_inclusive && !rhs.lb_inclusive);
+    }
+
+    bool
+    operator() (const NumericRange<T> &lhs, const T &x) const
+    {
+      return (lhs.lb < x) || (lhs.lb == x && lhs.lb_inclusive);
+    }
+
+    bool
+    operator() (const T &x, const NumericRange<T> &rhs) const
+    {
+      return !(*this)(rhs, x);
+    }
+  }; /* struct LowerBoundLess */
+
+  using set_type = std::set<NumericRange<T>, LowerBoundLess>;
+
+public:
+  using const_iterator = typename set_type::const_iterator;
+  using iterator = const_iterator;
+  using size_type = std::size_t;
+
+  RangeSet () = default;
+
+  /**
+   * Add every value of range to the set, merging it with all components it
+   * overlaps or touches.
+   * @param range
+   * @return Iterator to the component now containing range, or end() if
+   * range contains no values (e.g. (1, 2) for integers)
+   */
+  const_iterator
+  insert (const NumericRange<T> &range)
+  {
+    if (!(detail::closed_lb(range) <= detail::closed_ub(range)))
+    {
+      return end();
+    }
+
+    NumericRange<T> merged = range;
+    auto it = components_.lower_bound(range);
+    if (it != components_.begin() && touches(*std::prev(it), merged))
+    {
+      --it;
+    }
+    // Components after it start later, so stop at the first that leaves a gap
+    while (it != components_.end() && touches(merged, *it))
+    {
+      merged = merge(merged, *it);
+      it = components_.erase(it);
+    }
+    return components_.insert(it, merged);
+  }
+
+  /**
+   * @param x
+   * @return Iterator to the component containing x, or end()
+   */
+  const_iterator
+  find (const T &x) const
+  {
+    auto it = components_.upper_bound(x);
+    if (it == components_.begin())
+    {
+      return end();
+    }
+    --it;
+    const bool below = (it->ub < x) || (it->ub == x && !it->ub_inclusive);
+    return below ? end() : it;
+  }
+
+  bool
+  contains (const T &x) const
+  {
+    return find(x) != end();
+  }
+
+  /**
+   * @param range
+   * @return Whether every value of range is in the set
+   */
+  bool
+  contains (const NumericRange<T> &range) const
+  {
+    const T a = detail::closed_lb(range);
+    const T b = detail::closed_ub(range);
+    if (!(a <= b))
+    {
+      return true;
+    }
+    auto it = find(a);
+    return it != end() && b <= detail::closed_ub(*it);
+  }
+
+  const_iterator begin () const { return components_.begin(); }
+  const_iterator end () const { return components_.end(); }
+
+  /**
+   * @return Number of disjoint components
+   */
+  size_type size () const { return components_.size(); }
+  bool empty () const { return components_.empty(); }
+  void clear () { components_.clear(); }
+
+private:
+  set_type components_;
+
+  /**
+   * @return The next representable value after x, or x if there is none.
+   */
+  static T
+  successor (const T x)
+  {
+    if constexpr (std::is_floating_point<T>::value)
+    {
+      return std::nextafter(x, std::numeric_limits<T>::infinity());
+    }
+    else
+    {
+      return x == std::numeric_limits<T>::max() ? x : T(x + 1);
+    }
+  }
+
+  /**
+   * Whether b starts no later than immediately after the end of a, i.e.
+   * a followed by b leaves no gap. Always true if b starts before a ends.
+   */
+  static bool
+  touches (const NumericRange<T> &a, const NumericRange<T> &b)
+  {
+    const T a_hi = detail::closed_ub(a);
+    const T b_lo = detail::closed_lb(b);
+    return b_lo <= a_hi || b_lo == successor(a_hi);
+  }
+
+  static NumericRange<T>
+  merge (const NumericRange<T> &a, const NumericRange<T> &b)
+  {
+    NumericRange<T> result = LowerBoundLess()(b, a) ? b : a;
+    const bool b_ends_later = (a.ub < b.ub)
+                              || (a.ub == b.ub && b.ub_inclusive);
+    if (b_ends_later)
+    {
+      result.ub = b.ub;
+      result.ub_inclusive = b.ub_inclusive;
+    }
+    else
+    {
+      result.ub = a.ub;
+      result.ub_inclusive = a.ub_inclusive;
+    }
+    return result;
+  }
+}; /* class RangeSet */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_SET_HPP
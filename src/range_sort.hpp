@@ -0,0 +1,249 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Sorting of NumericRange sequences without NumericRangeComparator. Each
+ * range is reduced to an unsigned integer key whose order matches the
+ * comparator's for non-overlapping ranges, and the keys are radix sorted.
+ */
+
+#ifndef NUMERIC_RANGE_RANGE_SORT_HPP
+#define NUMERIC_RANGE_RANGE_SORT_HPP
+
+#include "numeric_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace numeric_range {
+
+namespace detail {
+
+/**
+ * Whether order_preserving_key supports T: integers of up to 64 bits,
+ * float and double.
+ */
+template<typename T>
+struct has_radix_key :
+    std::integral_constant<bool,
+        (std::is_integral<T>::value && sizeof(T) <= sizeof(std::uint64_t))
+        || std::is_same<T, float>::value || std::is_same<T, double>::value>
+{};
+
+/**
+ * Map x to an unsigned integer such that x < y iff key(x) < key(y). Only the
+ * low 8 * sizeof(T) bits of the result are used.
+ * Signed integers have their sign bit flipped. For IEEE-754 floating point,
+ * non-negative values have their sign bit set and negative values have all
+ * bits inverted, which reverses the order of their magnitudes. -0.0 maps to
+ * the same key as +0.0 since they compare equal. NaN has no meaningful key.
+ * @param x
+ * @return Order-preserving key of x
+ */
+template<typename T>
+std::uint64_t
+order_preserving_key (const T x) noexcept
+{
+  static_assert(has_radix_key<T>::value,
+                "order_preserving_key requires an integer of up to 64 bits, "
+                "float or double");
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    using bits_type = typename std::conditional<sizeof(T) == 4, std::uint32_t,
+                                                std::uint64_t>::type;
+    constexpr bits_type sign = bits_type(1) << (8 * sizeof(T) - 1);
+    const T value = (x == T(0)) ? T(0) : x;
+    bits_type bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return std::uint64_t((bits & sign) ? bits_type(~bits) : bits_type(bits | sign));
+  }
+  else if constexpr (std::is_signed<T>::value)
+  {
+    using unsigned_type = typename std::make_unsigned<T>::type;
+    constexpr unsigned_type sign = unsigned_type(unsigned_type(1)
+                                                 << (8 * sizeof(T) - 1));
+    return std::uint64_t(unsigned_type(unsigned_type(x) ^ sign));
+  }
+  else
+  {
+    return std::uint64_t(x);
+  }
+}
+
+/**
+ * A range reduced to its sort key and its position in the input.
+ */
+struct RadixItem
+{
+  std::uint64_t key;
+  std::size_t pos;
+};
+
+// Digits of 11 bits need 6 passes for 64-bit keys instead of 8 with bytes,
+// and their 2048 counters still fit in L1.
+constexpr unsigned radix_digit_bits = 11;
+constexpr std::size_t radix_buckets = std::size_t(1) << radix_digit_bits;
+
+// Below this size clearing and scanning the histograms costs more than a
+// comparison sort of the keys.
+constexpr std::size_t radix_sort_cutoff = 256;
+
+/**
+ * Stable LSD radix sort of the n items at items by (key, exclusive), where
+ * exclusive[pos] is the least significant digit, followed by the low
+ * KeyBits bits of key in digits of radix_digit_bits. Passes in which every
+ * item has the same digit are skipped. buffer is scratch space for n items.
+ * @return items or buffer, whichever holds the result
+ */
+template<unsigned KeyBits>
+RadixItem *
+radix_sort_items (RadixItem *items, RadixItem *buffer, std::size_t n,
+                  const unsigned char *exclusive)
+{
+  constexpr unsigned digits = (KeyBits + radix_digit_bits - 1)
+                              / radix_digit_bits;
+  constexpr std::uint64_t mask = radix_buckets - 1;
+
+  std::vector<std::size_t> histogram(digits * radix_buckets);
+  std::size_t exclusive_count = 0;
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    for (unsigned d = 0; d < digits; ++d)
+    {
+      ++histogram[d * radix_buckets
+                  + ((items[i].key >> (d * radix_digit_bits)) & mask)];
+    }
+    exclusive_count += exclusive[items[i].pos];
+  }
+
+  // Inclusive lower bounds precede exclusive ones at the same value
+  if (exclusive_count != 0 && exclusive_count != n)
+  {
+    std::size_t offset[2] = {0, n - exclusive_count};
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      buffer[offset[exclusive[items[i].pos]]++] = items[i];
+    }
+    std::swap(items, buffer);
+  }
+
+  for (unsigned d = 0; d < digits; ++d)
+  {
+    const unsigned shift = d * radix_digit_bits;
+    std::size_t *offset = histogram.data() + d * radix_buckets;
+    if (offset[(items[0].key >> shift) & mask] == n)
+    {
+      continue;
+    }
+    std::size_t sum = 0;
+    for (std::size_t b = 0; b < radix_buckets; ++b)
+    {
+      const std::size_t count = offset[b];
+      offset[b] = sum;
+      sum += count;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      buffer[offset[(items[i].key >> shift) & mask]++] = items[i];
+    }
+    std::swap(items, buffer);
+  }
+  return items;
+}
+
+/**
+ * The order produced by radix_sort_items, as a comparator.
+ */
+struct RadixItemLess
+{
+  const unsigned char *exclusive;
+
+  bool
+  operator() (const RadixItem &l, const RadixItem &r) const
+  {
+    return l.key < r.key
+           || (l.key == r.key && exclusive[l.pos] < exclusive[r.pos]);
+  }
+};
+
+/**
+ * Sort the n items at items stably by RadixItemLess, using a comparison
+ * sort for small inputs.
+ * @return items or buffer, whichever holds the result
+ */
+template<typename T>
+RadixItem *
+sort_items (RadixItem *items, RadixItem *buffer, std::size_t n,
+            const unsigned char *exclusive)
+{
+  if (n < radix_sort_cutoff)
+  {
+    std::stable_sort(items, items + n, RadixItemLess{exclusive});
+    return items;
+  }
+  return radix_sort_items<8 * sizeof(T)>(items, buffer, n, exclusive);
+}
+
+} /* namespace detail */
+
+/**
+ * Sort ranges into the order given by NumericRangeComparator<T>, for
+ * non-overlapping input, with an O(n) LSD radix sort on lower bounds.
+ * Ranges of such input that share a lower bound differ in its inclusivity,
+ * and the inclusive one comes first. The sort is stable, so ranges with
+ * identical lower bounds (e.g. duplicates) keep their relative order.
+ * Unlike std::sort with NumericRangeComparator, overlapping input does not
+ * throw; use disjoint_sorted_until on the result to validate it. NaN bounds
+ * are not supported.
+ * Types without an order-preserving key (e.g. long double) fall back to
+ * std::stable_sort with the comparator.
+ * @tparam T An arithmetic type.
+ * @param ranges
+ */
+template<typename T>
+void
+sort_ranges (std::vector<NumericRange<T> > &ranges)
+{
+  if constexpr (!detail::has_radix_key<T>::value)
+  {
+    std::stable_sort(ranges.begin(), ranges.end(), NumericRangeComparator<T>());
+  }
+  else
+  {
+    const std::size_t n = ranges.size();
+    if (n < 2)
+    {
+      return;
+    }
+
+    std::vector<detail::RadixItem> items(n);
+    std::vector<detail::RadixItem> buffer(n);
+    std::vector<unsigned char> exclusive(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      items[i] = {detail::order_preserving_key(ranges[i].lb), i};
+      exclusive[i] = !ranges[i].lb_inclusive;
+    }
+    const detail::RadixItem *result = detail::sort_items<T>(
+        items.data(), buffer.data(), n, exclusive.data());
+
+    std::vector<NumericRange<T> > sorted;
+    sorted.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      sorted.push_back(ranges[result[i].pos]);
+    }
+    ranges.swap(sorted);
+  }
+}
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_RANGE_SORT_HPP
@@ -0,0 +1,103 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Runtime selection of SIMD kernels. Kernels are compiled with per-function
+ * target attributes, so the library stays header-only and needs no special
+ * compiler flags; the widest instruction set supported by the running CPU is
+ * picked the first time a kernel is needed.
+ * Define NUMERIC_RANGE_NO_SIMD to always use the portable scalar code.
+ */
+
+#ifndef NUMERIC_RANGE_SIMD_DISPATCH_HPP
+#define NUMERIC_RANGE_SIMD_DISPATCH_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(NUMERIC_RANGE_NO_SIMD) && defined(__x86_64__) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define NUMERIC_RANGE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace numeric_range {
+
+namespace detail {
+
+enum class SimdLevel
+{
+  scalar,
+  avx2,
+  avx512
+};
+
+/**
+ * @return The widest kernel family usable on this CPU.
+ */
+inline SimdLevel
+detect_simd_level ()
+{
+#ifdef NUMERIC_RANGE_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+  {
+    return SimdLevel::avx512;
+  }
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return SimdLevel::avx2;
+  }
+#endif
+  return SimdLevel::scalar;
+}
+
+/**
+ * The detected SIMD level, computed once per process. Tests and benchmarks
+ * may lower it via set_simd_level to exercise narrower kernels.
+ */
+inline SimdLevel &
+simd_level_ref ()
+{
+  static SimdLevel level = detect_simd_level();
+  return level;
+}
+
+inline SimdLevel
+simd_level ()
+{
+  return simd_level_ref();
+}
+
+/**
+ * Restrict kernels to at most level. Requests wider than what the CPU
+ * supports are clamped. Not thread-safe with concurrent lookups.
+ * @param level
+ */
+inline void
+set_simd_level (SimdLevel level)
+{
+  const SimdLevel supported = detect_simd_level();
+  simd_level_ref() = (int(level) < int(supported)) ? level : supported;
+}
+
+/**
+ * Whether SIMD kernels exist for key type T: 32- and 64-bit signed integers
+ * and IEEE floats.
+ */
+template<typename T>
+struct simd_key
+    : std::integral_constant<bool,
+        (std::is_floating_point<T>::value
+         && (sizeof(T) == 4 || sizeof(T) == 8))
+        || (std::is_integral<T>::value && std::is_signed<T>::value
+            && (sizeof(T) == 4 || sizeof(T) == 8))>
+{};
+
+} /* namespace detail */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_SIMD_DISPATCH_HPP
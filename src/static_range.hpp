@@ -0,0 +1,251 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * Ranges whose bound kinds (inclusive or exclusive) are fixed at compile time
+ * by template parameters, e.g. HalfOpenRange<T> for [lb, ub). They store only
+ * the two bounds, and their comparator has no branches on bound kinds.
+ */
+
+#ifndef NUMERIC_RANGE_STATIC_RANGE_HPP
+#define NUMERIC_RANGE_STATIC_RANGE_HPP
+
+#include "numeric_range.hpp"
+
+#include <stdexcept>
+#include <type_traits>
+
+namespace numeric_range {
+
+/// Bound kind tag for an inclusive bound
+struct Closed {};
+
+/// Bound kind tag for an exclusive bound
+struct Open {};
+
+/**
+ * A range of values between two bounds whose inclusive/exclusive attributes
+ * are given by the tags LowerBound and UpperBound (Closed or Open).
+ * Exposes the same lb, lb_inclusive, ub and ub_inclusive members as
+ * NumericRange, with the inclusive attributes as compile-time constants.
+ * Convert to and from NumericRange<T> explicitly.
+ * Use the StaticRangeComparator to compare StaticRange objects.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam LowerBound Closed or Open
+ * @tparam UpperBound Closed or Open
+ */
+template<typename T, typename LowerBound, typename UpperBound>
+class StaticRange
+{
+  static_assert(std::is_same<LowerBound, Closed>::value
+                || std::is_same<LowerBound, Open>::value,
+                "LowerBound must be Closed or Open");
+  static_assert(std::is_same<UpperBound, Closed>::value
+                || std::is_same<UpperBound, Open>::value,
+                "UpperBound must be Closed or Open");
+
+public:
+  static constexpr bool lb_inclusive = std::is_same<LowerBound, Closed>::value;
+  static constexpr bool ub_inclusive = std::is_same<UpperBound, Closed>::value;
+
+  T lb = 0;
+  T ub = 0;
+
+  /**
+   * Construct a range from its lower and upper bound. The same constraints
+   * as for NumericRange apply:
+   * - LB <= UB
+   * - if LB == UB, both bounds must be inclusive
+   * @param _lb
+   * @param _ub
+   * @throws runtime_error If bounds are invalid
+   */
+  StaticRange (const T _lb, const T _ub) :
+      lb(_lb), ub(_ub)
+  {
+    if (lb > ub)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error("LB cannot be greater than UB"));
+    }
+    if (lb == ub && !(lb_inclusive && ub_inclusive))
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "LB and UB must be inclusive when LB == UB"));
+    }
+  }
+
+  /**
+   * Convert from a NumericRange with matching bound kinds.
+   * @param range
+   * @throws runtime_error If the bound kinds of range differ
+   */
+  explicit StaticRange (const NumericRange<T> &range) :
+      StaticRange(range.lb, range.ub)
+  {
+    if (range.lb_inclusive != lb_inclusive
+        || range.ub_inclusive != ub_inclusive)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Bound kinds of NumericRange do not match"));
+    }
+  }
+
+  /**
+   * Convert to the equivalent NumericRange with runtime bound kinds.
+   */
+  explicit operator NumericRange<T> () const
+  {
+    return NumericRange<T>(lb, lb_inclusive, ub, ub_inclusive);
+  }
+}; /* class StaticRange */
+
+/// [lb, ub]
+template<typename T>
+using ClosedRange = StaticRange<T, Closed, Closed>;
+
+/// [lb, ub)
+template<typename T>
+using HalfOpenRange = StaticRange<T, Closed, Open>;
+
+/// (lb, ub]
+template<typename T>
+using LeftOpenRange = StaticRange<T, Open, Closed>;
+
+/// (lb, ub)
+template<typename T>
+using OpenRange = StaticRange<T, Open, Open>;
+
+/**
+ * Counterpart of NumericRangeComparator for StaticRange objects of one kind,
+ * including heterogeneous comparisons with a raw scalar T. Since bound
+ * kinds are known at compile time, each comparison reduces to one or two
+ * comparisons of bound values.
+ * Like NumericRangeComparator, comparing overlapping ranges throws, and for
+ * ClosedRange a scalar range [x, x] inside another range is equivalent to
+ * it.
+ * @tparam T Recommend a numeric type that has a well-defined operator<.
+ * @tparam LowerBound Closed or Open
+ * @tparam UpperBound Closed or Open
+ */
+template<typename T, typename LowerBound, typename UpperBound>
+class StaticRangeComparator
+{
+  using range_type = StaticRange<T, LowerBound, UpperBound>;
+  static constexpr bool lb_inclusive = range_type::lb_inclusive;
+  static constexpr bool ub_inclusive = range_type::ub_inclusive;
+
+public:
+  using is_transparent = void;
+
+  /**
+   * @param lhs
+   * @param rhs
+   * @return Whether LHS < RHS
+   * @throws runtime_error When overlapping ranges are compared
+   */
+  bool
+  operator() (const range_type &lhs, const range_type &rhs) const
+  {
+    const RangeOrdering ordering = compare(lhs, rhs);
+    if (ordering == RangeOrdering::overlap)
+    {
+      NUMERIC_RANGE_THROW(std::runtime_error(
+          "Invalid comparison between overlapping ranges"));
+    }
+    return ordering == RangeOrdering::less;
+  }
+
+  /**
+   * Whether the range LHS lies entirely before the scalar RHS.
+   */
+  bool
+  operator() (const range_type &lhs, const T &rhs) const noexcept
+  {
+    if constexpr (ub_inclusive)
+    {
+      return lhs.ub < rhs;
+    }
+    else
+    {
+      return lhs.ub <= rhs;
+    }
+  }
+
+  /**
+   * Whether the scalar LHS lies entirely before the range RHS.
+   */
+  bool
+  operator() (const T &lhs, const range_type &rhs) const noexcept
+  {
+    if constexpr (lb_inclusive)
+    {
+      return lhs < rhs.lb;
+    }
+    else
+    {
+      return lhs <= rhs.lb;
+    }
+  }
+
+  /**
+   * Three-way comparison that never throws.
+   * See NumericRangeComparator::compare.
+   * @param lhs
+   * @param rhs
+   * @return How LHS is ordered relative to RHS
+   */
+  RangeOrdering
+  compare (const range_type &lhs, const range_type &rhs) const noexcept
+  {
+    if (lhs.lb == rhs.lb && lhs.ub == rhs.ub)
+    {
+      return RangeOrdering::equal;
+    }
+    // Ranges touching at a shared bound only overlap if both are closed
+    if constexpr (lb_inclusive && ub_inclusive)
+    {
+      if (lhs.ub < rhs.lb)
+      {
+        return RangeOrdering::less;
+      }
+      if (rhs.ub < lhs.lb)
+      {
+        return RangeOrdering::greater;
+      }
+      // Only closed ranges can be scalars
+      if (lhs.lb == lhs.ub)
+      {
+        return RangeOrdering::contained;
+      }
+      if (rhs.lb == rhs.ub)
+      {
+        return RangeOrdering::contains;
+      }
+      return RangeOrdering::overlap;
+    }
+    else
+    {
+      if (lhs.ub <= rhs.lb)
+      {
+        return RangeOrdering::less;
+      }
+      if (rhs.ub <= lhs.lb)
+      {
+        return RangeOrdering::greater;
+      }
+      return RangeOrdering::overlap;
+    }
+  }
+}; /* class StaticRangeComparator */
+
+template<typename T>
+using HalfOpenRangeComparator = StaticRangeComparator<T, Closed, Open>;
+
+template<typename T>
+using ClosedRangeComparator = StaticRangeComparator<T, Closed, Closed>;
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_STATIC_RANGE_HPP
@@ -0,0 +1,155 @@
+/*
+ * numeric_range
+ *
+ * Copyright (c) 2022 Amal Bansode <https://www.amalbansode.com>.
+ * Provided under the MIT License
+ *
+ * A minimal fork-join thread pool used by the parallel algorithms of this
+ * library, so that they depend on nothing beyond the standard library.
+ */
+
+#ifndef NUMERIC_RANGE_THREAD_POOL_HPP
+#define NUMERIC_RANGE_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace numeric_range {
+
+/**
+ * A fixed set of worker threads that execute one parallel_for at a time.
+ * The calling thread takes part in the work, so a pool of size 1 has no
+ * worker threads and runs everything inline.
+ */
+class ThreadPool
+{
+public:
+  /**
+   * @param threads Total number of threads to use, including the caller.
+   * Defaults to the number of hardware threads.
+   */
+  explicit ThreadPool (unsigned threads = std::thread::hardware_concurrency())
+  {
+    for (unsigned i = 1; i < threads; ++i)
+    {
+      workers_.emplace_back([this] { work(); });
+    }
+  }
+
+  ThreadPool (const ThreadPool &) = delete;
+  ThreadPool &operator= (const ThreadPool &) = delete;
+
+  ~ThreadPool ()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    start_.notify_all();
+    for (std::thread &worker : workers_)
+    {
+      worker.join();
+    }
+  }
+
+  /**
+   * @return Number of threads that take part in a parallel_for
+   */
+  unsigned size () const { return unsigned(workers_.size()) + 1; }
+
+  /**
+   * Call f(i) for every i in [0, count), distributed over the threads of the
+   * pool, and return once all calls have completed. Concurrent calls are
+   * serialized, and calls made from within f run inline on that thread.
+   * @param count
+   * @param f Callable taking a std::size_t. Must not throw.
+   */
+  template<typename F>
+  void
+  parallel_for (std::size_t count, F &&f)
+  {
+    if (workers_.empty() || count < 2 || inside_task_)
+    {
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        f(i);
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> serialize(submit_mutex_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = std::ref(f);
+      count_ = count;
+      next_.store(0, std::memory_order_relaxed);
+      active_ = workers_.size();
+      ++generation_;
+    }
+    start_.notify_all();
+    run_tasks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    task_ = nullptr;
+  }
+
+private:
+  std::vector<std::thread> workers_;
+  std::mutex submit_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  std::function<void(std::size_t)> task_;
+  std::size_t count_ = 0;
+  std::atomic<std::size_t> next_{0};
+  std::size_t active_ = 0;
+  std::size_t generation_ = 0;
+  bool stop_ = false;
+
+  static inline thread_local bool inside_task_ = false;
+
+  void
+  run_tasks ()
+  {
+    inside_task_ = true;
+    for (std::size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+         i < count_; i = next_.fetch_add(1, std::memory_order_relaxed))
+    {
+      task_(i);
+    }
+    inside_task_ = false;
+  }
+
+  void
+  work ()
+  {
+    std::size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+      start_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+      if (stop_)
+      {
+        return;
+      }
+      seen = generation_;
+      lock.unlock();
+      run_tasks();
+      lock.lock();
+      if (--active_ == 0)
+      {
+        done_.notify_one();
+      }
+    }
+  }
+}; /* class ThreadPool */
+
+} /* namespace numeric_range */
+
+#endif //NUMERIC_RANGE_THREAD_POOL_HPP
@@ -0,0 +1,168 @@
+#include "catch.hpp"
+#include "../src/bucketize.hpp"
+#include "random_ranges.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+// Run every strategy at every SIMD level and compare with expected.
+template<typename T, typename Table>
+static void
+check_bucketize (const Table &table, const vector<T> &values,
+                 const vector<uint32_t> &expected)
+{
+  for (auto strategy : {BucketizeStrategy::automatic, BucketizeStrategy::linear,
+                        BucketizeStrategy::search})
+  {
+    const Bucketizer<T> bucketizer(table, strategy);
+    for (auto level : {detail::SimdLevel::scalar, detail::SimdLevel::avx2,
+                       detail::SimdLevel::avx512})
+    {
+      detail::set_simd_level(level);
+      vector<uint32_t> out(values.size());
+      bucketizer.bucketize(values.data(), values.size(), out.data());
+      REQUIRE(out == expected);
+    }
+    detail::set_simd_level(detail::detect_simd_level());
+  }
+}
+
+template<typename T>
+static vector<T>
+probe_values (int lo, int hi)
+{
+  vector<T> values;
+  for (int x = lo; x < hi; ++x)
+  {
+    values.push_back(T(x));
+    if (std::is_floating_point<T>::value)
+    {
+      values.push_back(T(x + 0.5));
+    }
+  }
+  if (std::is_floating_point<T>::value)
+  {
+    values.push_back(numeric_limits<T>::quiet_NaN());
+    values.push_back(numeric_limits<T>::infinity());
+    values.push_back(-numeric_limits<T>::infinity());
+  }
+  values.push_back(numeric_limits<T>::max());
+  values.push_back(numeric_limits<T>::lowest());
+  return values;
+}
+
+template<typename T>
+static void
+check_sorted_ranges (size_t count)
+{
+  NumericRangeComparator<T> comp;
+  const int start = std::is_signed<T>::value ? -20 : 0;
+  const auto ranges = random_ranges<T>(count, unsigned(count), start);
+  const auto values = probe_values<T>(-30, int(ranges.back().ub) + 10);
+  vector<uint32_t> expected(values.size(), bucketize_miss);
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    if (std::isnan(double(values[i])))
+    {
+      continue;
+    }
+    for (size_t r = 0; r < ranges.size(); ++r)
+    {
+      if (!comp(ranges[r], values[i]) && !comp(values[i], ranges[r]))
+      {
+        expected[i] = uint32_t(r);
+      }
+    }
+  }
+  check_bucketize<T>(ranges, values, expected);
+
+  vector<uint32_t> out(values.size());
+  bucketize(values.data(), values.size(), ranges, out.data());
+  REQUIRE(out == expected);
+}
+
+template<typename T>
+static void
+check_partition (size_t count)
+{
+  // Adjacent ranges with random widths and sides
+  vector<NumericRange<T> > tiles;
+  int lb = -int(count);
+  bool lb_incl = true;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const int width = int(i * 7 % 3) + (lb_incl ? 0 : 1);
+    const bool ub_incl = width == 0 || i % 2 == 1;
+    tiles.emplace_back(T(lb), lb_incl, T(lb + width), ub_incl);
+    lb += width;
+    lb_incl = !ub_incl;
+  }
+  const RangePartition<T, int> partition(tiles, vector<int>(count));
+  const auto values = probe_values<T>(-int(count) - 5, lb + 5);
+  vector<uint32_t> expected(values.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    const size_t pos = partition.find_index(values[i]);
+    expected[i] = pos == partition.npos ? bucketize_miss : uint32_t(pos);
+  }
+  check_bucketize<T>(partition, values, expected);
+
+  vector<uint32_t> out(values.size());
+  bucketize(values.data(), values.size(), partition, out.data());
+  REQUIRE(out == expected);
+}
+
+TEST_CASE("bucketize sorted ranges", "[bucketize]" ) {
+  for (size_t count : {1, 5, 16, 100, 1000})
+  {
+    check_sorted_ranges<int32_t>(count);
+    check_sorted_ranges<int64_t>(count);
+    check_sorted_ranges<float>(count);
+    check_sorted_ranges<double>(count);
+    check_sorted_ranges<uint16_t>(count);
+  }
+}
+
+TEST_CASE("bucketize partitions", "[bucketize]" ) {
+  for (size_t count : {1, 5, 16, 100, 1000})
+  {
+    check_partition<int32_t>(count);
+    check_partition<int64_t>(count);
+    check_partition<float>(count);
+    check_partition<double>(count);
+  }
+}
+
+TEST_CASE("bucketize edge cases", "[bucketize]" ) {
+  // No buckets at all
+  const vector<int32_t> values{0, 1, 2, 3, 4, 5, 6, 7, 8};
+  check_bucketize<int32_t>(vector<NumericRange<int32_t> >{}, values,
+                           vector<uint32_t>(values.size(), bucketize_miss));
+
+  // Buckets including the ends of the domain
+  const int32_t min = numeric_limits<int32_t>::min();
+  const int32_t max = numeric_limits<int32_t>::max();
+  const RangePartition<int32_t, int> partition(
+      {{min, true, 0, true}, {0, false, max, true}}, {0, 1});
+  const vector<int32_t> ends{min, -1, 0, 1, max, max - 1, min + 1, 0};
+  check_bucketize<int32_t>(partition, ends, {0, 0, 0, 1, 1, 1, 0, 0});
+
+  const float inf = numeric_limits<float>::infinity();
+  const vector<NumericRange<float> > ranges{{-inf, true, 0, false},
+                                            {1, false, inf, true}};
+  const vector<float> floats{-inf, -1, 0, 0.5f, 1, 2, inf,
+                             numeric_limits<float>::quiet_NaN()};
+  check_bucketize<float>(ranges, floats, {0, 0, bucketize_miss, bucketize_miss,
+                                          bucketize_miss, 1, 1,
+                                          bucketize_miss});
+
+  // Overlapping ranges are rejected
+  const vector<NumericRange<int> > overlapping{{0, true, 2, true},
+                                               {1, true, 3, true}};
+  REQUIRE_THROWS_AS(Bucketizer<int>(overlapping), std::runtime_error);
+}
@@ -0,0 +1,310 @@
+#include "catch.hpp"
+#include "../src/canonical_range.hpp"
+#include "random_ranges.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+TEST_CASE("Half-open canonicalization", "[canonical_range]" ) {
+  const auto closed = to_half_open(NumericRange<int>(0, true, 2, true));
+  REQUIRE(closed.lb == 0);
+  REQUIRE(closed.ub == 3);
+  const auto open = to_half_open(NumericRange<int>(0, false, 2, false));
+  REQUIRE(open.lb == 1);
+  REQUIRE(open.ub == 2);
+  const auto scalar = to_half_open(NumericRange<int>(5));
+  REQUIRE(scalar.lb == 5);
+  REQUIRE(scalar.ub == 6);
+
+  // Back to a NumericRange covering the same values
+  const auto back = NumericRange<int>(open);
+  REQUIRE(back.lb == 1);
+  REQUIRE(back.lb_inclusive);
+  REQUIRE(back.ub == 2);
+  REQUIRE_FALSE(back.ub_inclusive);
+
+  // Explicit failures at the top of the domain and for empty ranges
+  const uint8_t max = numeric_limits<uint8_t>::max();
+  REQUIRE_THROWS_AS(to_half_open(NumericRange<uint8_t>(0, true, max, true)),
+                    std::overflow_error);
+  REQUIRE(to_half_open(NumericRange<uint8_t>(0, true, max, false)).ub == max);
+  REQUIRE_THROWS_AS(to_half_open(NumericRange<int>(0, false, 1, false)),
+                    std::runtime_error);
+
+  HalfOpenRange<int> out(7, 8);
+  REQUIRE_FALSE(try_to_half_open(NumericRange<int>(0, false, 1, false), out));
+  REQUIRE_FALSE(try_to_half_open(
+      NumericRange<int>(0, true, numeric_limits<int>::max(), true), out));
+  REQUIRE(out.lb == 7);
+  REQUIRE(try_to_half_open(NumericRange<int>(-3, false, -1, true), out));
+  REQUIRE(out.lb == -2);
+  REQUIRE(out.ub == 0);
+}
+
+TEST_CASE("Half-open comparator agrees with NumericRangeComparator",
+          "[canonical_range]" ) {
+  vector<NumericRange<int> > ranges;
+  for (int lb = 0; lb < 4; ++lb)
+  {
+    for (int ub = lb; ub < 4; ++ub)
+    {
+      for (int kinds = 0; kinds < 4; ++kinds)
+      {
+        const bool lb_incl = kinds & 1;
+        const bool ub_incl = kinds & 2;
+        if (NumericRange<int>::is_valid(lb, lb_incl, ub, ub_incl)
+            && (lb + !lb_incl) <= (ub - !ub_incl))
+        {
+          ranges.emplace_back(lb, lb_incl, ub, ub_incl);
+        }
+      }
+    }
+  }
+
+  // For integers, ranges covering disjoint values are ordered the same way
+  // whether or not they are canonical.
+  NumericRangeComparator<int> runtime_comp;
+  HalfOpenRangeComparator<int> comp;
+  for (const auto &lhs : ranges)
+  {
+    const auto lhs_canonical = to_half_open(lhs);
+    for (const auto &rhs : ranges)
+    {
+      const auto rhs_canonical = to_half_open(rhs);
+      const auto ordering = comp.compare(lhs_canonical, rhs_canonical);
+      if (ordering == RangeOrdering::less)
+      {
+        REQUIRE(runtime_comp.compare(lhs, rhs) != RangeOrdering::greater);
+      }
+      if (runtime_comp.compare(lhs, rhs) == RangeOrdering::less)
+      {
+        REQUIRE(ordering == RangeOrdering::less);
+      }
+    }
+    for (int x = -1; x < 5; ++x)
+    {
+      REQUIRE(comp(lhs_canonical, x) == runtime_comp(lhs, x));
+      REQUIRE(comp(x, lhs_canonical) == runtime_comp(x, lhs));
+    }
+  }
+}
+
+TEST_CASE("HalfOpenRangeIndex matches NumericRangeComparator",
+          "[canonical_range]" ) {
+  HalfOpenRangeIndex<int> empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == HalfOpenRangeIndex<int>::npos);
+
+  vector<NumericRange<int> > overlapping{{0, true, 1, true}, {1, true, 2, true}};
+  REQUIRE_THROWS_AS(HalfOpenRangeIndex<int>(overlapping), std::runtime_error);
+
+  NumericRangeComparator<int> comp;
+  for (unsigned seed = 0; seed < 20; ++seed)
+  {
+    const auto ranges = random_ranges<int>(200, seed, -50);
+    HalfOpenRangeIndex<int> index(ranges);
+    REQUIRE(index.size() == ranges.size());
+    for (int x = -60; x < ranges.back().ub + 10; ++x)
+    {
+      const auto pos = index.find(x);
+      if (pos == HalfOpenRangeIndex<int>::npos)
+      {
+        for (const auto &range : ranges)
+        {
+          REQUIRE((comp(range, x) || comp(x, range)));
+        }
+      }
+      else
+      {
+        REQUIRE_FALSE(comp(ranges[pos], x));
+        REQUIRE_FALSE(comp(x, ranges[pos]));
+      }
+    }
+  }
+}
+
+TEST_CASE("HalfOpenRangeIndex at the ends of the domain", "[canonical_range]" ) {
+  const auto npos = HalfOpenRangeIndex<int8_t>::npos;
+  const int8_t min = numeric_limits<int8_t>::min();
+  const int8_t max = numeric_limits<int8_t>::max();
+
+  // Ranges tiling the whole domain, including empty ones
+  vector<NumericRange<int8_t> > ranges{
+      {min, true, -1, true},
+      {-1, false, 0, false},
+      {0, true, 10, false},
+      {10, false, 11, false},
+      {11, true, max, true}};
+  HalfOpenRangeIndex<int8_t> index(ranges);
+  REQUIRE(index.find(min) == 0);
+  REQUIRE(index.find(-1) == 0);
+  REQUIRE(index.find(0) == 2);
+  REQUIRE(index.find(9) == 2);
+  REQUIRE(index.find(10) == npos);
+  REQUIRE(index.find(11) == 4);
+  REQUIRE(index.find(max - 1) == 4);
+  REQUIRE(index.find(max) == 4);
+
+  // Without the top value, max falls into a gap
+  ranges.back().ub_inclusive = false;
+  HalfOpenRangeIndex<int8_t> below_top(ranges);
+  REQUIRE(below_top.find(max - 1) == 4);
+  REQUIRE(below_top.find(max) == npos);
+
+  // A scalar at the top of an unsigned domain
+  const uint64_t top = numeric_limits<uint64_t>::max();
+  vector<NumericRange<uint64_t> > unsigned_ranges{
+      {0, true, 1, true}, NumericRange<uint64_t>(top)};
+  HalfOpenRangeIndex<uint64_t> unsigned_index(unsigned_ranges);
+  REQUIRE(unsigned_index.find(0) == 0);
+  REQUIRE(unsigned_index.find(2) == HalfOpenRangeIndex<uint64_t>::npos);
+  REQUIRE(unsigned_index.find(top - 1) == HalfOpenRangeIndex<uint64_t>::npos);
+  REQUIRE(unsigned_index.find(top) == 1);
+}
+
+TEST_CASE("Closed canonicalization", "[canonical_range]" ) {
+  const double inf = numeric_limits<double>::infinity();
+  const auto half_open = to_closed(NumericRange<double>(0, true, 1, false));
+  REQUIRE(half_open.lb == 0);
+  REQUIRE(half_open.ub == nextafter(1.0, 0.0));
+  const auto open = to_closed(NumericRange<double>(-inf, false, inf, false));
+  REQUIRE(open.lb == -numeric_limits<double>::max());
+  REQUIRE(open.ub == numeric_limits<double>::max());
+  const auto scalar = to_closed(NumericRange<float>(2.5f));
+  REQUIRE(scalar.lb == 2.5f);
+  REQUIRE(scalar.ub == 2.5f);
+
+  // No value lies strictly between adjacent representable values
+  const double next = nextafter(1.0, inf);
+  REQUIRE_THROWS_AS(to_closed(NumericRange<double>(1, false, next, false)),
+                    std::runtime_error);
+  ClosedRange<double> out(7, 8);
+  REQUIRE_FALSE(try_to_closed(NumericRange<double>(1, false, next, false),
+                              out));
+  REQUIRE(out.lb == 7);
+  REQUIRE(try_to_closed(NumericRange<double>(1, false, next, true), out));
+  REQUIRE(out.lb == next);
+  REQUIRE(out.ub == next);
+
+  // Round trip back to the original bounds and kinds
+  for (const auto &range : random_ranges<double>(200, 3, -100))
+  {
+    const auto back = from_closed(to_closed(range), range.lb_inclusive,
+                                  range.ub_inclusive);
+    REQUIRE(back.lb == range.lb);
+    REQUIRE(back.lb_inclusive == range.lb_inclusive);
+    REQUIRE(back.ub == range.ub);
+    REQUIRE(back.ub_inclusive == range.ub_inclusive);
+  }
+}
+
+TEST_CASE("ClosedRangeIndex matches NumericRangeComparator",
+          "[canonical_range]" ) {
+  ClosedRangeIndex<double> empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == ClosedRangeIndex<double>::npos);
+
+  vector<NumericRange<double> > overlapping{{0, true, 1, true},
+                                            {1, true, 2, true}};
+  REQUIRE_THROWS_AS(ClosedRangeIndex<double>(overlapping), std::runtime_error);
+
+  NumericRangeComparator<double> comp;
+  for (unsigned seed = 0; seed < 20; ++seed)
+  {
+    const auto ranges = random_ranges<double>(200, seed, -50);
+    ClosedRangeIndex<double> index(ranges);
+    REQUIRE(index.size() == ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+      REQUIRE(compare(index.range(i), ranges[i]) == RangeOrdering::equal);
+    }
+    for (double x = -60; x < ranges.back().ub + 10; x += 0.25)
+    {
+      for (const double probe : {nextafter(x, -1e9), x, nextafter(x, 1e9)})
+      {
+        const auto pos = index.find(probe);
+        if (pos == ClosedRangeIndex<double>::npos)
+        {
+          for (const auto &range : ranges)
+          {
+            REQUIRE((comp(range, probe) || comp(probe, range)));
+          }
+        }
+        else
+        {
+          REQUIRE_FALSE(comp(ranges[pos], probe));
+          REQUIRE_FALSE(comp(probe, ranges[pos]));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("ClosedRangeIndex edge values", "[canonical_range]" ) {
+  const float inf = numeric_limits<float>::infinity();
+  const float next = nextafter(1.0f, inf);
+  const auto npos = ClosedRangeIndex<float>::npos;
+  vector<NumericRange<float> > ranges{
+      {-inf, false, 0, false},
+      {0, true, 1, false},
+      {1, false, next, false},
+      {next, true, inf, true}};
+  ClosedRangeIndex<float> index(ranges);
+  REQUIRE(index.find(-inf) == npos);
+  REQUIRE(index.find(-numeric_limits<float>::max()) == 0);
+  REQUIRE(index.find(-0.0f) == 1);
+  REQUIRE(index.find(nextafter(1.0f, 0.0f)) == 1);
+  REQUIRE(index.find(1) == npos);
+  REQUIRE(index.find(next) == 3);
+  REQUIRE(index.find(inf) == 3);
+  REQUIRE(index.find(numeric_limits<float>::quiet_NaN()) == npos);
+
+  // The empty range converts back unchanged
+  const auto empty = index.range(2);
+  REQUIRE(empty.lb == 1);
+  REQUIRE_FALSE(empty.lb_inclusive);
+  REQUIRE(empty.ub == next);
+  REQUIRE_FALSE(empty.ub_inclusive);
+  REQUIRE(index.lbs()[3] == next);
+  REQUIRE(index.ubs()[0] == -numeric_limits<float>::denorm_min());
+}
+
+TEST_CASE("Canonical indexes interleaved lookup", "[canonical_range]" ) {
+  for (size_t count : {0, 1, 2, 7, 100, 1000})
+  {
+    const auto ints = random_ranges<int>(count, unsigned(count));
+    const auto doubles = random_ranges<double>(count, unsigned(count));
+    const HalfOpenRangeIndex<int> half_open(ints);
+    const ClosedRangeIndex<double> closed(doubles);
+    vector<int> int_keys;
+    vector<double> double_keys;
+    for (int x = -5; x < 3 * int(count) + 5; ++x)
+    {
+      int_keys.push_back(x);
+      double_keys.push_back(x);
+      double_keys.push_back(x + 0.5);
+    }
+    for (size_t group : {0, 1, 3, 16, 64, 100})
+    {
+      vector<uint32_t> out(int_keys.size());
+      half_open.lookup_interleaved(int_keys.data(), int_keys.size(),
+                                   out.data(), group);
+      for (size_t i = 0; i < int_keys.size(); ++i)
+      {
+        REQUIRE(out[i] == half_open.find(int_keys[i]));
+      }
+      out.resize(double_keys.size());
+      closed.lookup_interleaved(double_keys.data(), double_keys.size(),
+                                out.data(), group);
+      for (size_t i = 0; i < double_keys.size(); ++i)
+      {
+        REQUIRE(out[i] == closed.find(double_keys[i]));
+      }
+    }
+  }
+}
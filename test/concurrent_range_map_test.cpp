@@ -0,0 +1,134 @@
+#include "catch.hpp"
+#include "../src/concurrent_range_map.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+namespace {
+
+// Counts live instances to detect leaked or prematurely deleted versions
+struct Tracked
+{
+  static atomic<int> live;
+  int version;
+
+  explicit Tracked (int v) : version(v) { ++live; }
+  Tracked (const Tracked &other) : version(other.version) { ++live; }
+  Tracked &operator= (const Tracked &) = default;
+  ~Tracked () { version = -1; --live; }
+};
+
+atomic<int> Tracked::live{0};
+
+RangeMap<int, Tracked>
+make_version (int version)
+{
+  RangeMap<int, Tracked> map;
+  for (int i = 0; i < 16; ++i)
+  {
+    map.insert({10 * i, true, 10 * i + 5, false}, Tracked(version));
+  }
+  return map;
+}
+
+} /* namespace */
+
+TEST_CASE("ConcurrentRangeMap single thread", "[concurrent_range_map]" ) {
+  {
+    ConcurrentRangeMap<int, Tracked> map(make_version(0));
+    auto reader = map.reader();
+    REQUIRE(reader.find(12)->version == 0);
+    REQUIRE(!reader.find(7));
+    REQUIRE(!reader.contains(-1));
+
+    map.publish(make_version(1));
+    REQUIRE(reader.find(12)->version == 1);
+
+    map.update([] (RangeMap<int, Tracked> &m) {
+      m.insert({7, true, 8, true}, Tracked(2));
+    });
+    REQUIRE(reader.find(7)->version == 2);
+    REQUIRE(reader.find(12)->version == 1);
+
+    // With no read in progress, retired versions are deleted immediately
+    REQUIRE(map.reclaim() == 0);
+    REQUIRE(reader.read([] (const RangeMap<int, Tracked> &m) {
+      return m.size();
+    }) == 17);
+
+    // A retired version survives until the read using it ends
+    reader.read([&map] (const RangeMap<int, Tracked> &m) {
+      map.publish(make_version(3));
+      REQUIRE(map.reclaim() == 1);
+      REQUIRE(m.find(12)->second.version == 1);
+    });
+    REQUIRE(map.reclaim() == 0);
+    REQUIRE(reader.find(12)->version == 3);
+
+    // Slots of destroyed readers are reused
+    {
+      auto other = map.reader();
+      REQUIRE(other.contains(0));
+    }
+    auto again = map.reader();
+    REQUIRE(again.contains(0));
+  }
+  REQUIRE(Tracked::live == 0);
+}
+
+TEST_CASE("ConcurrentRangeMap readers see whole versions", "[concurrent_range_map]" ) {
+  {
+    ConcurrentRangeMap<int, Tracked> map(make_version(0));
+    atomic<bool> done{false};
+    atomic<long> reads{0};
+    atomic<int> errors{0};
+
+    vector<thread> readers;
+    for (int t = 0; t < 4; ++t)
+    {
+      readers.emplace_back([&] {
+        auto reader = map.reader();
+        int last = 0;
+        while (!done.load())
+        {
+          reader.read([&] (const RangeMap<int, Tracked> &m) {
+            // Every value of one snapshot belongs to the same version, and
+            // versions never go backwards
+            const int version = m.values().front().version;
+            for (const Tracked &v : m.values())
+            {
+              errors += v.version != version;
+            }
+            errors += version < last;
+            last = version;
+          });
+          ++reads;
+        }
+      });
+    }
+
+    for (int version = 1; version <= 300; ++version)
+    {
+      map.publish(make_version(version));
+      if (version % 50 == 0)
+      {
+        map.synchronize();
+      }
+      this_thread::yield();
+    }
+    done = true;
+    for (auto &t : readers)
+    {
+      t.join();
+    }
+    map.synchronize();
+    REQUIRE(errors == 0);
+    REQUIRE(reads > 0);
+    REQUIRE(Tracked::live == 16);
+  }
+  REQUIRE(Tracked::live == 0);
+}
@@ -0,0 +1,180 @@
+#include "catch.hpp"
+#include "../src/eytzinger_index.hpp"
+#include "random_ranges.hpp"
+
+#include <limits>
+#include <list>
+#include <map>
+
+using namespace std;
+using namespace numeric_range;
+
+TEST_CASE("EytzingerRangeIndex construction", "[eytzinger_index]" ) {
+  EytzingerRangeIndex<int> empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == EytzingerRangeIndex<int>::npos);
+
+  // Input must be sorted and non-overlapping
+  vector<NumericRange<int> > unsorted{{2, true, 3, true}, {0, true, 1, true}};
+  REQUIRE_THROWS_AS(EytzingerRangeIndex<int>(unsorted), std::runtime_error);
+
+  vector<NumericRange<int> > overlapping{{0, true, 1, true}, {1, true, 2, true}};
+  REQUIRE_THROWS_AS(EytzingerRangeIndex<int>(overlapping), std::runtime_error);
+}
+
+TEST_CASE("EytzingerRangeIndex bound semantics", "[eytzinger_index]" ) {
+  const double inf = numeric_limits<double>::infinity();
+  vector<NumericRange<double> > ranges{
+      {-inf, true, -1, false},
+      {0, false, 0.5, true},
+      {1, true, 1, true},
+      {1, false, 2, false},
+      {2, false, inf, true}};
+  EytzingerRangeIndex<double> index(ranges);
+  const auto npos = EytzingerRangeIndex<double>::npos;
+
+  REQUIRE(index.find(-inf) == 0);
+  REQUIRE(index.find(-1.000001) == 0);
+  REQUIRE(index.find(-1) == npos);
+  REQUIRE(index.find(0) == npos);
+  REQUIRE(index.find(0.25) == 1);
+  REQUIRE(index.find(0.5) == 1);
+  REQUIRE(index.find(0.75) == npos);
+  REQUIRE(index.find(1) == 2);
+  REQUIRE(index.find(1.5) == 3);
+  REQUIRE(index.find(2) == npos);
+  REQUIRE(index.find(inf) == 4);
+  REQUIRE(index.find(numeric_limits<double>::quiet_NaN()) == npos);
+}
+
+TEST_CASE("EytzingerRangeIndex matches std::map lookups", "[eytzinger_index]" ) {
+  for (size_t count : {1, 2, 3, 7, 8, 100, 1000})
+  {
+    const auto ranges = random_ranges<int>(count, unsigned(count));
+    std::map<NumericRange<int>, size_t, NumericRangeComparator<int> > reference;
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+      reference.insert({ranges[i], i});
+    }
+    EytzingerRangeIndex<int> index(ranges.begin(), ranges.end());
+    REQUIRE(index.size() == count);
+
+    for (int x = -2; x < ranges.back().ub + 2; ++x)
+    {
+      auto expected = reference.find(NumericRange<int>{x});
+      if (expected == reference.end())
+      {
+        REQUIRE(index.find(x) == EytzingerRangeIndex<int>::npos);
+      }
+      else
+      {
+        REQUIRE(index.find(x) == expected->second);
+      }
+    }
+  }
+}
+
+template<typename T>
+static void
+check_lookup_batch ()
+{
+  for (size_t count : {0, 1, 5, 64, 1000})
+  {
+    const auto ranges = random_ranges<T>(count, unsigned(count) + 1,
+                                       std::is_signed<T>::value ? -100 : 0);
+    EytzingerRangeIndex<T> index(ranges);
+
+    vector<T> keys;
+    for (int x = -104; x < (count ? int(ranges.back().ub) : 0) + 4; ++x)
+    {
+      keys.push_back(T(x));
+      if (std::is_floating_point<T>::value)
+      {
+        keys.push_back(T(x + 0.5));
+      }
+    }
+    if (std::is_floating_point<T>::value)
+    {
+      keys.push_back(numeric_limits<T>::quiet_NaN());
+      keys.push_back(numeric_limits<T>::infinity());
+      keys.push_back(-numeric_limits<T>::infinity());
+    }
+
+    for (auto level : {detail::SimdLevel::scalar, detail::SimdLevel::avx2,
+                       detail::SimdLevel::avx512})
+    {
+      detail::set_simd_level(level);
+      vector<typename EytzingerRangeIndex<T>::index_type> out(keys.size());
+      index.lookup_batch(keys.data(), keys.size(), out.data());
+      for (size_t i = 0; i < keys.size(); ++i)
+      {
+        REQUIRE(out[i] == index.find(keys[i]));
+      }
+    }
+    detail::set_simd_level(detail::detect_simd_level());
+  }
+
+  // A default-constructed index has no tree at all, unlike one built from
+  // an empty vector
+  const EytzingerRangeIndex<T> empty;
+  const vector<T> keys(16, T(1));
+  for (auto level : {detail::SimdLevel::scalar, detail::SimdLevel::avx2,
+                     detail::SimdLevel::avx512})
+  {
+    detail::set_simd_level(level);
+    vector<typename EytzingerRangeIndex<T>::index_type> out(keys.size(), 0);
+    empty.lookup_batch(keys.data(), keys.size(), out.data());
+    for (const auto pos : out)
+    {
+      REQUIRE(pos == EytzingerRangeIndex<T>::npos);
+    }
+  }
+  detail::set_simd_level(detail::detect_simd_level());
+}
+
+TEST_CASE("EytzingerRangeIndex batched lookup", "[eytzinger_index]" ) {
+  check_lookup_batch<int32_t>();
+  check_lookup_batch<int64_t>();
+  check_lookup_batch<float>();
+  check_lookup_batch<double>();
+  check_lookup_batch<int16_t>();
+  check_lookup_batch<uint32_t>();
+}
+
+TEST_CASE("EytzingerRangeIndex from non-vector input", "[eytzinger_index]" ) {
+  const auto ranges = random_ranges<int>(500, 5);
+  const std::list<NumericRange<int> > list(ranges.begin(), ranges.end());
+  const EytzingerRangeIndex<int> from_list(list.begin(), list.end());
+  const EytzingerRangeIndex<int> from_vector(ranges);
+  for (int x = ranges.front().lb - 2; x <= ranges.back().ub + 2; ++x)
+  {
+    REQUIRE(from_list.find(x) == from_vector.find(x));
+  }
+
+  vector<NumericRange<int> > overlapping{
+      {0, true, 1, true}, {2, true, 3, true}, {3, true, 4, true}};
+  REQUIRE_THROWS_WITH(EytzingerRangeIndex<int>(overlapping),
+                      Catch::Contains("positions 1 and 2"));
+}
+
+TEST_CASE("EytzingerRangeIndex interleaved lookup", "[eytzinger_index]" ) {
+  for (size_t count : {0, 1, 2, 7, 100, 1000})
+  {
+    const auto ranges = random_ranges<int>(count, unsigned(count));
+    const EytzingerRangeIndex<int> index(ranges);
+    vector<int> keys;
+    for (int x = -5; x < 3 * int(count) + 5; ++x)
+    {
+      keys.push_back(x);
+    }
+    for (size_t group : {0, 1, 3, 16, 64, 100})
+    {
+      vector<EytzingerRangeIndex<int>::index_type> out(keys.size());
+      index.lookup_interleaved(keys.data(), keys.size(), out.data(), group);
+      for (size_t i = 0; i < keys.size(); ++i)
+      {
+        REQUIRE(out[i] == index.find(keys[i]));
+      }
+    }
+  }
+}
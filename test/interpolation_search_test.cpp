@@ -0,0 +1,146 @@
+#include "catch.hpp"
+#include "../src/canonical_range.hpp"
+#include "../src/interpolation_search.hpp"
+#include "random_ranges.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+static const SearchStrategy all_strategies[] = {
+    SearchStrategy::binary, SearchStrategy::interpolation,
+    SearchStrategy::interpolation_sequential};
+
+// Every strategy must agree with a plain binary search on every probe.
+template<typename T>
+static void
+check_search (const vector<T> &a, const vector<T> &probes)
+{
+  for (const T x : probes)
+  {
+    const size_t expected = detail::last_le(a.data(), 0, a.size(), x);
+    REQUIRE(detail::interpolation_search(a.data(), a.size(), x) == expected);
+    REQUIRE(detail::interpolation_sequential_search(a.data(), a.size(), x)
+            == expected);
+  }
+}
+
+// Both indexes must resolve every probe to the same range as a RangeMap,
+// whichever the strategy.
+template<typename Index, typename T>
+static void
+check_index (const vector<NumericRange<T> > &ranges, const vector<T> &probes)
+{
+  for (const SearchStrategy strategy : all_strategies)
+  {
+    const Index index(ranges, strategy);
+    REQUIRE(index.strategy() == strategy);
+    check_matches_range_map(index, ranges, probes);
+  }
+}
+
+TEST_CASE("Interpolation searches match binary search",
+          "[interpolation_search]" ) {
+  mt19937_64 gen(3);
+  for (const size_t size : {1, 2, 3, 10, 1000, 20000})
+  {
+    // Evenly spread, heavily skewed and clustered values with duplicates
+    vector<int64_t> even, skewed, clustered;
+    for (size_t i = 0; i < size; ++i)
+    {
+      even.push_back(int64_t(7 * i));
+      skewed.push_back(int64_t(std::pow(1.002, double(i))));
+      clustered.push_back(i % 100 == 99 ? int64_t(1) << 50 : int64_t(i / 3));
+    }
+    sort(clustered.begin(), clustered.end());
+    for (const auto *a : {&even, &skewed, &clustered})
+    {
+      vector<int64_t> probes{numeric_limits<int64_t>::min(),
+                             numeric_limits<int64_t>::max(), -1,
+                             (int64_t(1) << 50) - 1, int64_t(1) << 50};
+      for (int i = 0; i < 2000; ++i)
+      {
+        probes.push_back(a->front() + int64_t(gen() % (a->back() - a->front()
+                                                       + 2)));
+        probes.push_back((*a)[gen() % a->size()]);
+      }
+      check_search(*a, probes);
+    }
+  }
+
+  const double inf = numeric_limits<double>::infinity();
+  const vector<double> doubles{-inf, -1e300, -1, 0, 0, 1e-300, 1, 1e300, inf};
+  vector<double> probes(doubles);
+  probes.insert(probes.end(), {-2, 0.5, 2, 1e299,
+                               numeric_limits<double>::max(),
+                               numeric_limits<double>::quiet_NaN()});
+  check_search(doubles, probes);
+
+  const vector<uint64_t> unsigned_bounds{0, 1, uint64_t(1) << 63,
+                                         numeric_limits<uint64_t>::max()};
+  check_search(unsigned_bounds,
+               vector<uint64_t>{0, 1, 2, uint64_t(1) << 62,
+                                (uint64_t(1) << 63) + 1,
+                                numeric_limits<uint64_t>::max() - 1,
+                                numeric_limits<uint64_t>::max()});
+}
+
+TEST_CASE("Range indexes keep their semantics with every strategy",
+          "[interpolation_search]" ) {
+  for (unsigned seed = 0; seed < 5; ++seed)
+  {
+    for (const size_t count : {1, 2, 3, 100, 3000})
+    {
+      const auto ints = random_ranges<int>(count, seed, -40);
+      const auto doubles = random_ranges<double>(count, seed, -40);
+      vector<int> int_probes;
+      vector<double> double_probes;
+      for (int x = -50; x < int(ints.back().ub) + 10; ++x)
+      {
+        int_probes.push_back(x);
+        double_probes.push_back(x);
+        double_probes.push_back(x + 0.5);
+      }
+      check_index<HalfOpenRangeIndex<int> >(ints, int_probes);
+      check_index<ClosedRangeIndex<double> >(doubles, double_probes);
+    }
+  }
+
+  // Geometrically growing ranges defeat interpolation
+  vector<NumericRange<int64_t> > skewed;
+  vector<int64_t> probes;
+  int64_t lb = 0;
+  for (int i = 0; i < 5000; ++i)
+  {
+    const int64_t width = 1 + lb / 150;
+    skewed.emplace_back(lb, i % 2 == 0, lb + width, i % 3 == 0);
+    probes.insert(probes.end(), {lb - 1, lb, lb + 1, lb + width / 2,
+                                 lb + width});
+    lb += width + i % 2;
+  }
+  probes.push_back(numeric_limits<int64_t>::max());
+  check_index<HalfOpenRangeIndex<int64_t> >(skewed, probes);
+
+  // The top of the domain and values no double can tell apart
+  const int64_t max = numeric_limits<int64_t>::max();
+  const vector<NumericRange<int64_t> > top{{0, true, 1, false},
+                                           {max - 3, true, max - 2, false},
+                                           {max - 2, true, max, true}};
+  check_index<HalfOpenRangeIndex<int64_t> >(
+      top, vector<int64_t>{-1, 0, 1, max - 4, max - 3, max - 2, max - 1, max});
+
+  const float inf = numeric_limits<float>::infinity();
+  const vector<NumericRange<float> > floats{{-inf, true, -1, false},
+                                            {0, true, 0, true},
+                                            {0, false, 1, false},
+                                            {1, false, inf, true}};
+  check_index<ClosedRangeIndex<float> >(
+      floats, vector<float>{-inf, -2, -1, 0, 0.5f, 1, 2, inf,
+                            numeric_limits<float>::quiet_NaN()});
+}
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+#include "../src/interval_tree.hpp"
+
+#include <algorithm>
+#include <random>
+
+using namespace std;
+using namespace numeric_range;
+
+// Whether scalar x lies in range according to NumericRangeComparator
+template<typename T>
+static bool
+contains (const NumericRange<T> &range, T x)
+{
+  NumericRangeComparator<T> comp;
+  return !comp(NumericRange<T>{x}, range) && !comp(range, NumericRange<T>{x});
+}
+
+static vector<NumericRange<int> >
+random_overlapping_ranges (size_t count, unsigned seed)
+{
+  mt19937 gen(seed);
+  vector<NumericRange<int> > ranges;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const int lb = int(gen() % 100);
+    const int width = int(gen() % 20);
+    const bool lb_incl = width == 0 || gen() % 2;
+    const bool ub_incl = width == 0 || gen() % 2;
+    ranges.emplace_back(lb, lb_incl, lb + width, ub_incl);
+  }
+  return ranges;
+}
+
+TEST_CASE("IntervalTree stabbing queries", "[interval_tree]" ) {
+  vector<NumericRange<double> > ranges{
+      {0, true, 10, false},
+      {5, false, 6, true},
+      {5, true, 5, true},
+      {6, true, 20, true},
+      {1, false, 1.5, false}};
+  IntervalTree<double> tree(ranges);
+
+  auto sorted = [] (vector<size_t> v) { sort(v.begin(), v.end()); return v; };
+  REQUIRE(sorted(tree.containing(5)) == vector<size_t>{0, 2});
+  REQUIRE(sorted(tree.containing(6)) == vector<size_t>{0, 1, 3});
+  REQUIRE(sorted(tree.containing(10)) == vector<size_t>{3});
+  REQUIRE(sorted(tree.containing(1)) == vector<size_t>{0});
+  REQUIRE(sorted(tree.containing(1.25)) == vector<size_t>{0, 4});
+  REQUIRE(tree.containing(-1).empty());
+  REQUIRE(tree.containing(20.5).empty());
+
+  REQUIRE(IntervalTree<int>().containing(0).empty());
+}
+
+TEST_CASE("IntervalTree matches brute force", "[interval_tree]" ) {
+  for (size_t count : {1, 2, 10, 200})
+  {
+    const auto ranges = random_overlapping_ranges(count, unsigned(count));
+    IntervalTree<int> tree(ranges.begin(), ranges.end());
+
+    for (int x = -2; x < 125; ++x)
+    {
+      vector<size_t> expected;
+      for (size_t i = 0; i < ranges.size(); ++i)
+      {
+        if (contains(ranges[i], x))
+        {
+          expected.push_back(i);
+        }
+      }
+      auto actual = tree.containing(x);
+      sort(actual.begin(), actual.end());
+      REQUIRE(actual == expected);
+    }
+
+    for (const auto &query : random_overlapping_ranges(100, 99))
+    {
+      vector<size_t> expected;
+      for (size_t i = 0; i < ranges.size(); ++i)
+      {
+        for (int x = query.lb; x <= query.ub; ++x)
+        {
+          if (contains(ranges[i], x) && contains(query, x))
+          {
+            expected.push_back(i);
+            break;
+          }
+        }
+      }
+      auto actual = tree.overlapping(query);
+      sort(actual.begin(), actual.end());
+      REQUIRE(actual == expected);
+    }
+  }
+}
@@ -0,0 +1,167 @@
+#include "catch.hpp"
+#include "../src/ip_index.hpp"
+#include "random_ranges.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+// Every probe must resolve to the same range as in a RangeMap, both through
+// find() and through interleaved lookups.
+template<typename T>
+static void
+check_probes (const vector<NumericRange<T> > &ranges, const vector<T> &probes)
+{
+  const IpRangeIndex<T> index(ranges);
+  check_matches_range_map(index, ranges, probes);
+
+  for (const size_t group : {1, 5, 16})
+  {
+    vector<typename IpRangeIndex<T>::index_type> out(probes.size());
+    index.lookup_interleaved(probes.data(), probes.size(), out.data(), group);
+    for (size_t i = 0; i < probes.size(); ++i)
+    {
+      REQUIRE(out[i] == index.find(probes[i]));
+    }
+  }
+}
+
+// Ranges of random lengths between random gaps, each shifted left by shift
+// bits, with probes at and around every bound
+template<typename T>
+static void
+check_random (size_t count, unsigned seed, unsigned shift)
+{
+  mt19937_64 gen(seed);
+  vector<NumericRange<T> > ranges;
+  vector<T> probes;
+  T lb = T(gen() % 100);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const T width = T(gen() % (i % 7 == 0 ? 1000 : 4));
+    const bool lb_incl = width == 0 || gen() % 2;
+    const bool ub_incl = width == 0 || gen() % 2;
+    ranges.emplace_back(lb << shift, lb_incl, (lb + width) << shift, ub_incl);
+    for (const T x : {lb, T(lb + width)})
+    {
+      probes.insert(probes.end(), {T(x << shift), T((x << shift) + 1),
+                                   T((x << shift) - 1)});
+    }
+    lb += width + T(1 + gen() % (i % 5 == 0 ? 100000 : 3));
+  }
+  probes.push_back(0);
+  probes.push_back(T(-1));
+  check_probes(ranges, probes);
+}
+
+TEST_CASE("IpRangeIndex matches NumericRangeComparator", "[ip_index]" ) {
+  Ipv4RangeIndex empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == Ipv4RangeIndex::npos);
+  uint32_t key = 0;
+  uint32_t out = 0;
+  empty_index.lookup_interleaved(&key, 1, &out);
+  REQUIRE(out == Ipv4RangeIndex::npos);
+
+  vector<NumericRange<uint32_t> > overlapping{{0, true, 1, true},
+                                              {1, true, 2, true}};
+  REQUIRE_THROWS_AS(Ipv4RangeIndex(overlapping), std::runtime_error);
+
+  for (unsigned seed = 0; seed < 5; ++seed)
+  {
+    for (const size_t count : {1, 8, 9, 100, 5000})
+    {
+      const auto ranges = random_ranges<uint32_t>(count, seed);
+      vector<uint32_t> probes;
+      for (uint32_t x = 0; x < ranges.back().ub + 10; ++x)
+      {
+        probes.push_back(x);
+      }
+      check_probes(ranges, probes);
+      check_random<uint32_t>(count, seed, 0);
+      check_random<uint64_t>(count, seed, 20);
+#ifdef NUMERIC_RANGE_HAS_INT128
+      check_random<uint128_t>(count, seed, 0);
+      check_random<uint128_t>(count, seed, 64);
+      check_random<uint128_t>(count, seed, 90);
+#endif
+    }
+  }
+}
+
+TEST_CASE("IpRangeIndex trie shape", "[ip_index]" ) {
+  // Few ranges fit one leaf
+  vector<NumericRange<uint32_t> > few;
+  for (uint32_t i = 0; i < Ipv4RangeIndex::leaf_run; ++i)
+  {
+    few.emplace_back(i << 24, true, (i << 24) + 255, true);
+  }
+  const Ipv4RangeIndex leaf(few);
+  REQUIRE(leaf.node_count() == 0);
+  REQUIRE(leaf.depth() == 0);
+  REQUIRE(leaf.find(3u << 24 | 17) == 3);
+  REQUIRE(leaf.find(3u << 24 | 256) == Ipv4RangeIndex::npos);
+
+  // /24 blocks spread over the whole IPv4 space
+  vector<NumericRange<uint32_t> > blocks;
+  vector<uint32_t> probes;
+  for (uint32_t i = 0; i < 65536; ++i)
+  {
+    const uint32_t lb = i << 16 | (i % 251) << 8;
+    blocks.emplace_back(lb, true, lb | 255, true);
+    probes.insert(probes.end(), {lb - 1, lb, lb | 128, lb | 255, lb + 256});
+  }
+  const Ipv4RangeIndex spread(blocks);
+  REQUIRE(spread.depth() <= 2);
+  REQUIRE(spread.trie_size() > 0);
+  REQUIRE(spread.memory_usage() >= spread.trie_size());
+  check_probes(blocks, probes);
+
+#ifdef NUMERIC_RANGE_HAS_INT128
+  // /48 prefixes under 2001:db8::/32 share their 32 leading bits, which the
+  // trie skips instead of spending nodes on them
+  const uint128_t prefix = uint128_t(0x20010db800000000ULL) << 64;
+  vector<NumericRange<uint128_t> > v6;
+  vector<uint128_t> v6_probes{0, prefix - 1, prefix, uint128_t(-1)};
+  mt19937_64 gen(4);
+  uint128_t lb = prefix;
+  for (int i = 0; i < 20000; ++i)
+  {
+    lb += uint128_t(1 + gen() % 8) << 80;
+    const uint128_t ub = lb + (uint128_t(1) << 80) - 1;
+    v6.emplace_back(lb, true, ub, true);
+    v6_probes.insert(v6_probes.end(), {lb - 1, lb, lb + gen(), ub, ub + 1});
+    lb = ub;
+  }
+  const Ipv6RangeIndex index(v6);
+  REQUIRE(index.depth() <= 3);
+  check_probes(v6, v6_probes);
+#endif
+}
+
+TEST_CASE("IpRangeIndex edge values", "[ip_index]" ) {
+  const uint32_t max = 0xFFFFFFFF;
+  const vector<NumericRange<uint32_t> > ends{{0, true, 0, true},
+                                             {0, false, 1, false},
+                                             {1, true, 3, false},
+                                             {max - 1, false, max, true}};
+  check_probes(ends, vector<uint32_t>{0, 1, 2, 3, max - 1, max});
+
+#ifdef NUMERIC_RANGE_HAS_INT128
+  const uint128_t top = uint128_t(-1);
+  vector<NumericRange<uint128_t> > wide{{0, true, 1, true}};
+  vector<uint128_t> probes{0, 1, 2, top - 1, top};
+  // Bounds on both sides of the highest bit, and a range reaching the top
+  for (unsigned bit = 1; bit < 128; bit += 7)
+  {
+    const uint128_t lb = uint128_t(1) << bit;
+    wide.emplace_back(lb, false, lb + 1, true);
+    probes.insert(probes.end(), {lb, lb + 1, lb + 2});
+  }
+  wide.emplace_back(top - 5, true, top, true);
+  check_probes(wide, probes);
+#endif
+}
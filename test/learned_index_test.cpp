@@ -0,0 +1,123 @@
+#include "catch.hpp"
+#include "../src/learned_index.hpp"
+#include "random_ranges.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+// Every probe must resolve to the same range as in a RangeMap.
+template<typename T>
+static void
+check_probes (const vector<NumericRange<T> > &ranges, const vector<T> &probes,
+              size_t max_error)
+{
+  const LearnedRangeIndex<T> index(ranges, max_error);
+  check_matches_range_map(index, ranges, probes);
+}
+
+template<typename T>
+static void
+check_random (size_t count, unsigned seed)
+{
+  const auto ranges = random_ranges<T>(count, seed, -40);
+  vector<T> probes;
+  for (int x = -50; x < int(ranges.back().ub) + 10; ++x)
+  {
+    probes.push_back(T(x));
+    if (std::is_floating_point<T>::value)
+    {
+      probes.push_back(T(x + 0.5));
+    }
+  }
+  for (const size_t max_error : {0, 1, 4, 32})
+  {
+    check_probes(ranges, probes, max_error);
+  }
+}
+
+TEST_CASE("LearnedRangeIndex matches NumericRangeComparator",
+          "[learned_index]" ) {
+  LearnedRangeIndex<int> empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == LearnedRangeIndex<int>::npos);
+
+  vector<NumericRange<int> > overlapping{{0, true, 1, true}, {1, true, 2, true}};
+  REQUIRE_THROWS_AS(LearnedRangeIndex<int>(overlapping), std::runtime_error);
+
+  for (unsigned seed = 0; seed < 10; ++seed)
+  {
+    for (const size_t count : {1, 2, 3, 100, 2000})
+    {
+      check_random<int>(count, seed);
+      check_random<int64_t>(count, seed);
+      check_random<double>(count, seed);
+      check_random<float>(count, seed);
+    }
+  }
+}
+
+TEST_CASE("LearnedRangeIndex model size", "[learned_index]" ) {
+  // Evenly spaced ranges fit a single line
+  vector<NumericRange<double> > even;
+  for (int i = 0; i < 10000; ++i)
+  {
+    even.emplace_back(2 * i, true, 2 * i + 1, false);
+  }
+  const LearnedRangeIndex<double> one_line(even, 4);
+  REQUIRE(one_line.segment_count() == 1);
+  REQUIRE(one_line.model_size() > 0);
+  REQUIRE(one_line.find(3.0) == LearnedRangeIndex<double>::npos);
+  REQUIRE(one_line.find(19998.5) == 9999);
+
+  // Irregular ranges need more segments for a tighter error bound
+  const auto ranges = random_ranges<int>(10000, 5);
+  const LearnedRangeIndex<int> loose(ranges, 64);
+  const LearnedRangeIndex<int> tight(ranges, 2);
+  REQUIRE(loose.segment_count() < tight.segment_count());
+  REQUIRE(tight.max_error() == 2);
+}
+
+TEST_CASE("LearnedRangeIndex edge values", "[learned_index]" ) {
+  // Bounds that doubles cannot tell apart still resolve exactly
+  const int64_t base = int64_t(1) << 60;
+  vector<NumericRange<int64_t> > ranges;
+  vector<int64_t> probes;
+  for (int64_t i = 0; i < 3000; ++i)
+  {
+    ranges.emplace_back(base + 3 * i, i % 2 == 0, base + 3 * i + 2, true);
+    for (int64_t d = -1; d < 4; ++d)
+    {
+      probes.push_back(base + 3 * i + d);
+    }
+  }
+  probes.push_back(numeric_limits<int64_t>::min());
+  probes.push_back(numeric_limits<int64_t>::max());
+  check_probes(ranges, probes, 8);
+
+  // Empty ranges and the ends of the domain
+  const int max = numeric_limits<int>::max();
+  const int min = numeric_limits<int>::min();
+  const vector<NumericRange<int> > ends{{min, true, min, true},
+                                        {1, false, 2, false},
+                                        {2, true, 3, false},
+                                        {max - 1, false, max, true}};
+  check_probes(ends, vector<int>{min, min + 1, 0, 1, 2, 3, max - 1, max}, 0);
+
+  const double inf = numeric_limits<double>::infinity();
+  const vector<NumericRange<double> > doubles{{-inf, true, -1, false},
+                                              {0, true, 0, true},
+                                              {1, false, inf, true}};
+  const LearnedRangeIndex<double> index(doubles);
+  REQUIRE(index.find(-inf) == 0);
+  REQUIRE(index.find(-1) == LearnedRangeIndex<double>::npos);
+  REQUIRE(index.find(0) == 1);
+  REQUIRE(index.find(1) == LearnedRangeIndex<double>::npos);
+  REQUIRE(index.find(inf) == 2);
+  REQUIRE(index.find(numeric_limits<double>::quiet_NaN())
+          == LearnedRangeIndex<double>::npos);
+}
@@ -3,6 +3,9 @@
 #include "catch.hpp"
 #include "../src/numeric_range.hpp"
 
+#include <map>
+#include <vector>
+
 using namespace std;
 using namespace numeric_range;
 
@@ -242,3 +245,127 @@ TEST_CASE("Scalar equals Range UB", "[numeric_range]" ) {
   REQUIRE(comp(scalar, range) == false);
   REQUIRE(comp(range, scalar) == true);
 }
+
+/// Three-way Comparison Tests
+
+TEST_CASE("Three-way comparison", "[numeric_range]" ) {
+  NumericRangeComparator<int> comp;
+
+  const NumericRange A = NumericRange<int>(0, true, 2, false);
+
+  REQUIRE(comp.compare(A, NumericRange<int>(0, true, 2, false)) == RangeOrdering::equal);
+  REQUIRE(comp.compare(A, NumericRange<int>(2, true, 3, true)) == RangeOrdering::less);
+  REQUIRE(comp.compare(A, NumericRange<int>(-1, true, 0, false)) == RangeOrdering::greater);
+  REQUIRE(comp.compare(A, NumericRange<int>(1, true, 3, true)) == RangeOrdering::overlap);
+  REQUIRE(comp.compare(A, NumericRange<int>(-1, true, 3, true)) == RangeOrdering::overlap);
+
+  REQUIRE(comp.compare(A, NumericRange<int>(1)) == RangeOrdering::contains);
+  REQUIRE(comp.compare(NumericRange<int>(1), A) == RangeOrdering::contained);
+  REQUIRE(comp.compare(A, NumericRange<int>(2)) == RangeOrdering::less);
+  REQUIRE(comp.compare(NumericRange<int>(2), A) == RangeOrdering::greater);
+  REQUIRE(compare(NumericRange<int>(2), NumericRange<int>(2)) == RangeOrdering::equal);
+}
+
+TEST_CASE("Three-way comparison agrees with operator()", "[numeric_range]" ) {
+  NumericRangeComparator<int> comp;
+
+  vector<NumericRange<int> > ranges;
+  for (int lb = 0; lb < 4; ++lb)
+  {
+    for (int ub = lb; ub < 4; ++ub)
+    {
+      for (int flags = 0; flags < 4; ++flags)
+      {
+        if (NumericRange<int>::is_valid(lb, flags & 1, ub, flags & 2))
+        {
+          ranges.emplace_back(lb, flags & 1, ub, flags & 2);
+        }
+      }
+    }
+  }
+
+  for (const auto &lhs : ranges)
+  {
+    for (const auto &rhs : ranges)
+    {
+      const RangeOrdering ordering = comp.compare(lhs, rhs);
+      if (ordering == RangeOrdering::overlap)
+      {
+        REQUIRE_THROWS_AS(comp(lhs, rhs), std::runtime_error);
+      }
+      else
+      {
+        REQUIRE(comp(lhs, rhs) == (ordering == RangeOrdering::less));
+      }
+    }
+  }
+
+  REQUIRE_FALSE(NumericRange<int>::is_valid(1, true, 0, true));
+  REQUIRE_FALSE(NumericRange<int>::is_valid(0, false, 0, true));
+}
+
+/// Heterogeneous (Scalar T) Comparison Tests
+
+TEST_CASE("Raw scalar comparisons match scalar ranges", "[numeric_range]" ) {
+  NumericRangeComparator<int> comp;
+
+  for (int flags = 0; flags < 4; ++flags)
+  {
+    const NumericRange<int> range(1, flags & 1, 3, flags & 2);
+    for (int x = 0; x < 5; ++x)
+    {
+      REQUIRE(comp(range, x) == comp(range, NumericRange<int>(x)));
+      REQUIRE(comp(x, range) == comp(NumericRange<int>(x), range));
+    }
+  }
+
+  const NumericRange<int> scalar(2);
+  REQUIRE(comp(scalar, 3));
+  REQUIRE_FALSE(comp(scalar, 2));
+  REQUIRE_FALSE(comp(2, scalar));
+  REQUIRE(comp(1, scalar));
+}
+
+#ifdef NUMERIC_RANGE_HAS_INT128
+TEST_CASE("128-bit bounds", "[numeric_range]" ) {
+  static_assert(detail::is_integer<uint128_t>::value, "uint128_t is integral");
+  static_assert(detail::is_arithmetic<int128_t>::value,
+                "int128_t is arithmetic");
+
+  // IPv6 prefixes 2001:db8::/32 and 2001:db9::/32
+  const uint128_t db8 = uint128_t(0x20010db800000000ULL) << 64;
+  const uint128_t db9 = uint128_t(0x20010db900000000ULL) << 64;
+  const uint128_t width = uint128_t(1) << 96;
+  const NumericRange<uint128_t> a(db8, true, db8 + width, false);
+  const NumericRange<uint128_t> b(db9, true, db9 + width - 1, true);
+  REQUIRE_THROWS_AS(NumericRange<uint128_t>(db9, true, db8, true),
+                    std::runtime_error);
+
+  NumericRangeComparator<uint128_t> comp;
+  REQUIRE(compare(a, b) == RangeOrdering::less);
+  REQUIRE(compare(b, NumericRange<uint128_t>(db9 + 1))
+          == RangeOrdering::contains);
+  REQUIRE(comp(a, db9));
+  REQUIRE_FALSE(comp(a, db8 + width - 1));
+  REQUIRE(comp(db8 - 1, a));
+  REQUIRE(detail::closed_ub(a) == db8 + width - 1);
+  REQUIRE(detail::closed_lb(NumericRange<uint128_t>(db8, false, db9, true))
+          == db8 + 1);
+
+  // Bounds that differ only above 64 bits
+  std::map<NumericRange<uint128_t>, int, NumericRangeComparator<uint128_t> >
+      map{{a, 1}, {b, 2}};
+  REQUIRE(map.find(db8 + (uint128_t(1) << 90))->second == 1);
+  REQUIRE(map.find(db9 + width - 1)->second == 2);
+  REQUIRE(map.find(db9 + width) == map.end());
+  REQUIRE(map.find(uint128_t(0x20010db8)) == map.end());
+  REQUIRE_THROWS_AS(map.insert({{db8 + width - 1, true, db9, true}, 3}),
+                    std::runtime_error);
+
+  const int128_t min = -(int128_t(1) << 126);
+  const NumericRange<int128_t> negative(min, false, -1, true);
+  REQUIRE(NumericRangeComparator<int128_t>()(min, negative));
+  REQUIRE(compare(negative, NumericRange<int128_t>(min + 1))
+          == RangeOrdering::contains);
+}
+#endif
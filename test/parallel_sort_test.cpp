@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "../src/parallel_sort.hpp"
+#include "random_ranges.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+
+using namespace std;
+using namespace numeric_range;
+
+namespace {
+
+template<typename T>
+bool
+identical (const vector<NumericRange<T> > &a, const vector<NumericRange<T> > &b)
+{
+  return a.size() == b.size()
+         && std::equal(a.begin(), a.end(), b.begin(),
+                       [] (const NumericRange<T> &l, const NumericRange<T> &r) {
+                         return l.lb == r.lb && l.lb_inclusive == r.lb_inclusive
+                                && l.ub == r.ub && l.ub_inclusive == r.ub_inclusive;
+                       });
+}
+
+template<typename T>
+void
+check_matches_serial (ThreadPool &pool, std::size_t count, unsigned seed)
+{
+  auto ranges = random_ranges<T>(count, seed, std::is_signed<T>::value ? -1000 : 0);
+  // Duplicates exercise stability across slices
+  ranges.insert(ranges.end(), ranges.begin(), ranges.begin() + count / 3);
+  std::shuffle(ranges.begin(), ranges.end(), std::mt19937(seed));
+
+  auto serial = ranges;
+  sort_ranges(serial);
+  auto parallel = ranges;
+  parallel_sort_ranges(parallel, pool);
+  REQUIRE(identical(serial, parallel));
+}
+
+} /* namespace */
+
+TEST_CASE("ThreadPool runs every task once", "[parallel_sort]" ) {
+  for (const unsigned threads : {1u, 3u, 8u})
+  {
+    ThreadPool pool(threads);
+    REQUIRE(pool.size() == threads);
+    for (int round = 0; round < 20; ++round)
+    {
+      vector<atomic<int> > hits(1000);
+      pool.parallel_for(hits.size(), [&] (size_t i) {
+        hits[i].fetch_add(1);
+        // Nested calls run inline
+        int nested = 0;
+        pool.parallel_for(3, [&nested] (size_t) { ++nested; });
+        hits[i].fetch_add(nested - 3);
+      });
+      REQUIRE(std::all_of(hits.begin(), hits.end(),
+                          [] (const atomic<int> &h) { return h.load() == 1; }));
+    }
+  }
+}
+
+TEST_CASE("parallel_sort_ranges matches sort_ranges", "[parallel_sort]" ) {
+  for (const unsigned threads : {1u, 2u, 3u, 7u, 16u})
+  {
+    ThreadPool pool(threads);
+    for (const size_t count : {100, 20000, 100000})
+    {
+      check_matches_serial<int>(pool, count, threads);
+      check_matches_serial<int64_t>(pool, count, threads + 1);
+      check_matches_serial<uint32_t>(pool, count, threads + 2);
+      check_matches_serial<double>(pool, count, threads + 3);
+    }
+  }
+}
+
+TEST_CASE("parallel_disjoint_sorted_until matches serial", "[parallel_sort]" ) {
+  ThreadPool pool(5);
+  auto ranges = random_ranges<int>(100000, 3);
+  REQUIRE(parallel_disjoint_sorted_until(ranges.begin(), ranges.end(), pool)
+          == ranges.end());
+
+  // Several offending pairs; the first one must be reported
+  for (const size_t pos : {99999, 50000, 20001, 1})
+  {
+    ranges[pos] = ranges[pos - 1];
+    REQUIRE(parallel_disjoint_sorted_until(ranges.begin(), ranges.end(), pool)
+            == disjoint_sorted_until(ranges.begin(), ranges.end()));
+    REQUIRE(parallel_disjoint_sorted_until(ranges.begin(), ranges.end(), pool)
+            == ranges.begin() + pos);
+  }
+}
@@ -0,0 +1,153 @@
+#include "catch.hpp"
+#include "../src/radix_index.hpp"
+#include "random_ranges.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+// Every probe must resolve to the same range as in a RangeMap, both through
+// find() and through every batched kernel.
+template<typename T>
+static void
+check_probes (const vector<NumericRange<T> > &ranges, const vector<T> &probes)
+{
+  const RadixRangeIndex<T> index(ranges);
+  check_matches_range_map(index, ranges, probes);
+
+  for (auto level : {detail::SimdLevel::scalar, detail::SimdLevel::avx2,
+                     detail::SimdLevel::avx512})
+  {
+    detail::set_simd_level(level);
+    vector<typename RadixRangeIndex<T>::index_type> out(probes.size());
+    index.lookup_batch(probes.data(), probes.size(), out.data());
+    for (size_t i = 0; i < probes.size(); ++i)
+    {
+      REQUIRE(out[i] == index.find(probes[i]));
+    }
+  }
+  detail::set_simd_level(detail::detect_simd_level());
+}
+
+template<typename T>
+static void
+check_random (size_t count, unsigned seed, int start)
+{
+  const auto ranges = random_ranges<T>(count, seed, start);
+  vector<T> probes;
+  for (int x = start - 10; x < int(ranges.back().ub) + 10; ++x)
+  {
+    probes.push_back(T(x));
+  }
+  check_probes(ranges, probes);
+}
+
+TEST_CASE("RadixRangeIndex matches NumericRangeComparator",
+          "[radix_index]" ) {
+  RadixRangeIndex<uint32_t> empty_index;
+  REQUIRE(empty_index.empty());
+  REQUIRE(empty_index.find(0) == RadixRangeIndex<uint32_t>::npos);
+  uint32_t key = 0;
+  uint32_t out = 0;
+  empty_index.lookup_batch(&key, 1, &out);
+  REQUIRE(out == RadixRangeIndex<uint32_t>::npos);
+
+  vector<NumericRange<uint64_t> > overlapping{{0, true, 1, true},
+                                              {1, true, 2, true}};
+  REQUIRE_THROWS_AS(RadixRangeIndex<uint64_t>(overlapping), std::runtime_error);
+
+  for (unsigned seed = 0; seed < 5; ++seed)
+  {
+    for (const size_t count : {1, 2, 3, 100, 5000})
+    {
+      check_random<uint32_t>(count, seed, 20);
+      check_random<uint64_t>(count, seed, 20);
+      check_random<int32_t>(count, seed, -1000);
+      check_random<int64_t>(count, seed, -1000);
+      check_random<int16_t>(count, seed, -1000);
+    }
+  }
+}
+
+TEST_CASE("RadixRangeIndex chooses its table from the data",
+          "[radix_index]" ) {
+  // Evenly spread ranges get half a scan of lower bounds per slot
+  vector<NumericRange<uint32_t> > even;
+  for (uint32_t i = 0; i < 4096; ++i)
+  {
+    even.emplace_back(1000 + 16 * i, true, 1000 + 16 * i + 8, false);
+  }
+  const RadixRangeIndex<uint32_t> even_index(even);
+  REQUIRE(RadixRangeIndex<uint32_t>::scan_width == 16);
+  REQUIRE(even_index.radix_bits() == 9);
+  REQUIRE(even_index.slot_count() <= 512);
+  REQUIRE(even_index.max_run() <= 9);
+  REQUIRE(even_index.table_size() == (even_index.slot_count() + 1) * 4);
+  REQUIRE(even_index.memory_usage() >= even_index.table_size());
+  REQUIRE(even_index.find(999) == RadixRangeIndex<uint32_t>::npos);
+  REQUIRE(even_index.find(1000 + 16 * 4095 + 7) == 4095);
+
+  // A dense cluster at the bottom of a wide span takes extra bits, and what
+  // still does not fit one scan is searched
+  vector<NumericRange<uint64_t> > clustered;
+  vector<uint64_t> probes;
+  for (uint64_t i = 0; i < 3000; ++i)
+  {
+    clustered.emplace_back(2 * i, true, 2 * i, true);
+  }
+  for (uint64_t i = 1; i <= 1000; ++i)
+  {
+    clustered.emplace_back(i << 40, false, (i << 40) + 5, true);
+    probes.insert(probes.end(), {i << 40, (i << 40) + 1, (i << 40) + 6});
+  }
+  for (uint64_t x = 0; x < 6010; ++x)
+  {
+    probes.push_back(x);
+  }
+  const RadixRangeIndex<uint64_t> clustered_index(clustered);
+  REQUIRE(clustered_index.radix_bits() > 12);
+  REQUIRE(clustered_index.max_run() > RadixRangeIndex<uint64_t>::scan_width);
+  check_probes(clustered, probes);
+}
+
+TEST_CASE("RadixRangeIndex edge values", "[radix_index]" ) {
+  const uint64_t umax = numeric_limits<uint64_t>::max();
+  const vector<NumericRange<uint64_t> > unsigned_ends{
+      {0, true, 0, true}, {1, false, 3, false},
+      {umax - 2, true, umax - 1, false}, {umax - 1, false, umax, true}};
+  check_probes(unsigned_ends, vector<uint64_t>{0, 1, 2, 3, umax - 3, umax - 2,
+                                               umax - 1, umax});
+
+  const int64_t max = numeric_limits<int64_t>::max();
+  const int64_t min = numeric_limits<int64_t>::min();
+  const vector<NumericRange<int64_t> > signed_ends{{min, true, min, true},
+                                                   {-1, false, 1, false},
+                                                   {max - 1, false, max, true}};
+  check_probes(signed_ends, vector<int64_t>{min, min + 1, -1, 0, 1, max - 1,
+                                            max});
+
+  // Ranges that contain no integer keep their position but never match
+  const vector<NumericRange<uint32_t> > empty_ranges{{0, false, 1, false},
+                                                     {1, true, 2, false},
+                                                     {2, false, 3, false},
+                                                     {3, true, 3, true}};
+  check_probes(empty_ranges, vector<uint32_t>{0, 1, 2, 3, 4});
+
+  mt19937_64 gen(9);
+  vector<NumericRange<uint32_t> > sparse;
+  vector<uint32_t> sparse_probes;
+  uint32_t lb = 0;
+  for (int i = 0; i < 2000; ++i)
+  {
+    lb += 1 + uint32_t(gen() % 1000000);
+    sparse.emplace_back(lb, true, lb + 10, i % 2 == 0);
+    sparse_probes.insert(sparse_probes.end(), {lb - 1, lb, lb + 9, lb + 10,
+                                               uint32_t(gen())});
+    lb += 10;
+  }
+  check_probes(sparse, sparse_probes);
+}
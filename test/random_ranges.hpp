@@ -0,0 +1,65 @@
+#ifndef NUMERIC_RANGE_TEST_RANDOM_RANGES_HPP
+#define NUMERIC_RANGE_TEST_RANDOM_RANGES_HPP
+
+#include "catch.hpp"
+#include "../src/numeric_range.hpp"
+#include "../src/range_map.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <random>
+#include <vector>
+
+// Generate count sorted, non-overlapping ranges with random widths, gaps and
+// bound kinds, starting at start. Consecutive ranges frequently touch so
+// that every inclusive/exclusive combination at a shared bound is covered.
+template<typename T>
+std::vector<numeric_range::NumericRange<T> >
+random_ranges (std::size_t count, unsigned seed, int start = 0)
+{
+  std::vector<numeric_range::NumericRange<T> > ranges;
+  std::mt19937 gen(seed);
+  int lb = start;
+  bool touching = false;
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const int width = int(gen() % 4) + (touching ? 1 : 0);
+    const bool lb_incl = width == 0 || (!touching && gen() % 2);
+    const bool ub_incl = width == 0 || gen() % 2;
+    ranges.emplace_back(T(lb), lb_incl, T(lb + width), ub_incl);
+    const int gap = int(gen() % 2);
+    lb += width + gap;
+    touching = gap == 0 && ub_incl;
+  }
+  return ranges;
+}
+
+// Every probe must resolve in index to the same range as in a RangeMap of
+// ranges: find() returns its position in ranges, or Index::npos.
+template<typename Index, typename T>
+void
+check_matches_range_map (const Index &index,
+                         const std::vector<numeric_range::NumericRange<T> >
+                             &ranges,
+                         const std::vector<T> &probes)
+{
+  const numeric_range::RangeMap<T, int> map(numeric_range::sorted_unique,
+                                            ranges,
+                                            std::vector<int>(ranges.size()));
+  REQUIRE(index.size() == ranges.size());
+  for (const T x : probes)
+  {
+    const auto it = map.find(x);
+    const auto pos = index.find(x);
+    if (it == map.end())
+    {
+      REQUIRE(pos == Index::npos);
+    }
+    else
+    {
+      REQUIRE(pos == std::size_t(std::distance(map.begin(), it)));
+    }
+  }
+}
+
+#endif //NUMERIC_RANGE_TEST_RANDOM_RANGES_HPP
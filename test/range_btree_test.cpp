@@ -0,0 +1,219 @@
+#include "catch.hpp"
+#include "../src/range_btree.hpp"
+#include "../src/range_map.hpp"
+#include "random_ranges.hpp"
+
+#include <random>
+#include <string>
+
+using namespace std;
+using namespace numeric_range;
+
+// Compare the contents of a RangeBTree with a RangeMap holding the same
+// ranges, in both directions of iteration and through scalar lookups.
+template<typename T, typename V>
+static void
+check_same (const RangeBTree<T, V> &tree, const RangeMap<T, V> &map, int lo,
+            int hi)
+{
+  REQUIRE(tree.size() == map.size());
+  REQUIRE(size_t(std::distance(tree.begin(), tree.end())) == map.size());
+  auto expected = map.begin();
+  for (const auto &kv : tree)
+  {
+    REQUIRE(compare(kv.first, expected->first) == RangeOrdering::equal);
+    REQUIRE(kv.second == expected->second);
+    ++expected;
+  }
+  auto it = tree.end();
+  for (size_t i = map.size(); i > 0; --i)
+  {
+    --it;
+    REQUIRE(it->second == map.values()[i - 1]);
+  }
+  for (int x = lo; x < hi; ++x)
+  {
+    const auto actual = tree.find(T(x));
+    const auto wanted = map.find(T(x));
+    REQUIRE((actual == tree.end()) == (wanted == map.end()));
+    if (wanted != map.end())
+    {
+      REQUIRE(actual->second == wanted->second);
+    }
+  }
+}
+
+TEST_CASE("RangeBTree insertion and ordering", "[range_btree]" ) {
+  RangeBTree<int, double> tree;
+  REQUIRE(tree.empty());
+  REQUIRE(tree.height() == 0);
+  REQUIRE(tree.begin() == tree.end());
+
+  REQUIRE(tree.insert({5, false, 6, true}, 5).second);
+  REQUIRE(tree.insert({0, true, 1, false}, 0).second);
+  REQUIRE(tree.insert({1, false, 3, false}, 1).second);
+  REQUIRE(tree.size() == 3);
+
+  // Overlapping ranges are rejected just like with NumericRangeComparator
+  REQUIRE_THROWS_AS(tree.insert({1, true, 4, false}, 2), std::runtime_error);
+  REQUIRE_THROWS_AS(tree.insert({-1, true, 0, true}, 2), std::runtime_error);
+  REQUIRE(tree.size() == 3);
+
+  // Re-inserting an equivalent key does not replace its value
+  auto res = tree.insert({0, true, 1, false}, 42);
+  REQUIRE(res.second == false);
+  REQUIRE(res.first->second == 0);
+
+  vector<int> lbs;
+  for (const auto &kv : tree)
+  {
+    lbs.push_back(kv.first.lb);
+  }
+  REQUIRE(lbs == vector<int>{0, 1, 5});
+}
+
+TEST_CASE("RangeBTree scalar lookup", "[range_btree]" ) {
+  RangeBTree<int, double> tree;
+  tree.insert({0, true, 1, false}, 0);
+  tree.insert({1, false, 3, false}, 1);
+  tree.insert({5, false, 6, true}, 5);
+  tree.insert({8, true, 8, true}, 8);
+
+  REQUIRE(tree.at(0) == 0);
+  REQUIRE(tree.at(2) == 1);
+  REQUIRE(tree.at(6) == 5);
+  REQUIRE(tree.at(8) == 8);
+  REQUIRE(tree.contains(8));
+
+  REQUIRE(tree.find(1) == tree.end());
+  REQUIRE(tree.find(3) == tree.end());
+  REQUIRE(tree.find(5) == tree.end());
+  REQUIRE(tree.find(-1) == tree.end());
+  REQUIRE(tree.find(9) == tree.end());
+  REQUIRE_THROWS_AS(tree.at(4), std::out_of_range);
+
+  REQUIRE(tree.find(NumericRange<int>{2})->second == 1);
+  REQUIRE(tree.find(NumericRange<int>{4}) == tree.end());
+  REQUIRE_THROWS_AS(tree.find(NumericRange<int>{0, true, 2, true}),
+                    std::runtime_error);
+
+  RangeBTree<double, int> floats;
+  floats.insert({0, true, 1, true}, 1);
+  REQUIRE(floats.find(std::numeric_limits<double>::quiet_NaN())
+          == floats.end());
+}
+
+TEST_CASE("RangeBTree non-throwing insertion and erase", "[range_btree]" ) {
+  RangeBTree<int, string> tree;
+
+  auto res = tree.try_insert({0, true, 2, false}, "a");
+  REQUIRE(res.status == InsertStatus::inserted);
+  res = tree.try_insert({4, true, 6, false}, "b");
+  REQUIRE(res.status == InsertStatus::inserted);
+  res = tree.try_insert({0, true, 2, false}, "c");
+  REQUIRE(res.status == InsertStatus::exists);
+  REQUIRE(res.position->second == "a");
+  res = tree.try_insert({1, true, 5, false}, "d");
+  REQUIRE(res.status == InsertStatus::overlap);
+  res = tree.try_insert({3, true, 5, false}, "d");
+  REQUIRE(res.status == InsertStatus::overlap);
+  REQUIRE(res.position->first.lb == 4);
+
+  // An lvalue is copied, not moved from
+  string value = "e";
+  REQUIRE(tree.try_insert({2, true, 4, false}, value).status
+          == InsertStatus::inserted);
+  REQUIRE(value == "e");
+
+  REQUIRE(tree.erase(NumericRange<int>{2, true, 4, false}) == 1);
+  REQUIRE(tree.erase(NumericRange<int>{2, true, 4, false}) == 0);
+  REQUIRE_THROWS_AS(tree.erase(NumericRange<int>{1, true, 5, false}),
+                    std::runtime_error);
+  auto next = tree.erase(tree.find(1));
+  REQUIRE(next->second == "b");
+  REQUIRE(tree.erase(next) == tree.end());
+  REQUIRE(tree.empty());
+  REQUIRE(tree.height() == 0);
+}
+
+TEST_CASE("RangeBTree ascending inserts fill leaves", "[range_btree]" ) {
+  RangeBTree<int, int> tree;
+  const size_t count = 100 * RangeBTree<int, int>::node_capacity;
+  RangeMap<int, int> map;
+  for (const auto &range : random_ranges<int>(count, 3))
+  {
+    tree.insert(range, int(map.size()));
+    map.insert(range, int(map.size()));
+  }
+  REQUIRE(tree.height() >= 2);
+  check_same(tree, map, -2, map.keys().back().ub + 2);
+}
+
+TEST_CASE("RangeBTree matches RangeMap under random updates",
+          "[range_btree]" ) {
+  mt19937 gen(11);
+  RangeBTree<int, int> tree;
+  RangeMap<int, int> map;
+  const int domain = 40000;
+  // Grow to a few levels, then shrink back to nothing
+  for (const size_t target : {size_t(8000), size_t(2000), size_t(6000),
+                              size_t(0)})
+  {
+    size_t steps = 0;
+    while (map.size() != target)
+    {
+      const bool grow = map.size() < target
+                        ? gen() % 4 != 0 : gen() % 4 == 0;
+      if (grow)
+      {
+        const int lb = int(gen() % domain);
+        const int width = int(gen() % 6);
+        const bool lb_incl = width == 0 || gen() % 2;
+        const bool ub_incl = width == 0 || gen() % 2;
+        const NumericRange<int> range(lb, lb_incl, lb + width, ub_incl);
+        const int value = int(gen());
+        const auto expected = map.try_insert(range, value);
+        const auto actual = tree.try_insert(range, value);
+        REQUIRE(actual.status == expected.status);
+        if (actual.status != InsertStatus::overlap)
+        {
+          REQUIRE(compare(actual.position->first, expected.position->first)
+                  == RangeOrdering::equal);
+        }
+      }
+      else if (!map.empty())
+      {
+        const size_t pos = gen() % map.size();
+        const NumericRange<int> key = map.keys()[pos];
+        map.erase(key);
+        if (gen() % 2)
+        {
+          REQUIRE(tree.erase(key) == 1);
+        }
+        else
+        {
+          const auto next = tree.erase(tree.find(key));
+          if (pos == map.size())
+          {
+            REQUIRE(next == tree.end());
+          }
+          else
+          {
+            REQUIRE(compare(next->first, map.keys()[pos])
+                    == RangeOrdering::equal);
+          }
+        }
+      }
+      if (++steps % 2000 == 0)
+      {
+        check_same(tree, map, -2, domain + 8);
+      }
+    }
+    check_same(tree, map, -2, domain + 8);
+    if (target == 8000)
+    {
+      REQUIRE(tree.height() >= 3);
+    }
+  }
+  REQUIRE(tree.height() == 0);
+}
@@ -0,0 +1,81 @@
+#include "catch.hpp"
+#include "../src/range_columns.hpp"
+#include "../src/range_map.hpp"
+#include "random_ranges.hpp"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+using namespace numeric_range;
+
+namespace {
+
+template<typename T>
+bool
+identical (const NumericRange<T> &l, const NumericRange<T> &r)
+{
+  return l.lb == r.lb && l.lb_inclusive == r.lb_inclusive && l.ub == r.ub
+         && l.ub_inclusive == r.ub_inclusive;
+}
+
+} /* namespace */
+
+TEST_CASE("RangeColumns stores ranges", "[range_columns]" ) {
+  const auto ranges = random_ranges<double>(300, 4, -50);
+  RangeColumns<double> columns(ranges);
+  REQUIRE(columns.size() == ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    REQUIRE(identical(std::as_const(columns)[i], ranges[i]));
+    REQUIRE(columns.lbs()[i] == ranges[i].lb);
+    REQUIRE(columns.ubs()[i] == ranges[i].ub);
+  }
+
+  // Iterators yield NumericRange values and work with standard algorithms
+  REQUIRE(std::equal(columns.begin(), columns.end(), ranges.begin(),
+                     identical<double>));
+  REQUIRE(columns.end() - columns.begin() == ptrdiff_t(ranges.size()));
+  REQUIRE(columns.begin()[5].lb == ranges[5].lb);
+  REQUIRE((columns.begin() + 7)->ub_inclusive == ranges[7].ub_inclusive);
+  REQUIRE(disjoint_sorted_until(columns.begin(), columns.end()) == columns.end());
+
+  // Assignment through the proxy
+  const NumericRange<double> replacement{ranges[10].lb, false, ranges[10].ub, true};
+  columns[10] = replacement;
+  REQUIRE(identical(NumericRange<double>(columns[10]), replacement));
+  columns[11] = columns[12];
+  REQUIRE(identical(NumericRange<double>(columns[11]), ranges[12]));
+
+  // Bitsets shrink and grow with the columns across word boundaries
+  for (size_t i = 0; i < 200; ++i)
+  {
+    columns.pop_back();
+  }
+  REQUIRE(columns.size() == 100);
+  columns.push_back({1000, false, 1001, true});
+  REQUIRE(!columns.lb_inclusive(100));
+  REQUIRE(columns.ub_inclusive(100));
+  REQUIRE(identical(std::as_const(columns)[99], ranges[99]));
+
+  columns.clear();
+  REQUIRE(columns.empty());
+  REQUIRE(columns.find(0) == RangeColumns<double>::npos);
+}
+
+TEST_CASE("RangeColumns lookup matches RangeMap", "[range_columns]" ) {
+  const auto ranges = random_ranges<int>(2000, 6, -100);
+  const RangeColumns<int> columns(ranges.begin(), ranges.end());
+  RangeMap<int, size_t> map;
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    map.insert(ranges[i], i);
+  }
+  for (int x = ranges.front().lb - 2; x <= ranges.back().ub + 2; ++x)
+  {
+    const auto it = map.find(x);
+    const size_t expected = it == map.end() ? RangeColumns<int>::npos : it->second;
+    REQUIRE(columns.find(x) == expected);
+  }
+  REQUIRE(columns.memory_usage() < ranges.size() * sizeof(NumericRange<int>));
+}
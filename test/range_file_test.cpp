@@ -0,0 +1,134 @@
+#include "catch.hpp"
+#include "../src/range_file.hpp"
+#include "random_ranges.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace std;
+using namespace numeric_range;
+
+namespace {
+
+// A file in the temporary directory that is removed when it goes out of
+// scope. Its name includes the process id, so concurrent runs do not collide.
+struct TempFile
+{
+  string path;
+
+  explicit TempFile (const string &name) :
+      path((std::filesystem::temp_directory_path()
+            / (name + "." + to_string(::getpid()))).string())
+  {}
+
+  ~TempFile () { std::remove(path.c_str()); }
+};
+
+struct Payload
+{
+  int32_t id;
+  float weight;
+};
+
+} /* namespace */
+
+TEST_CASE("Range file round trip", "[range_file]" ) {
+  TempFile file("numeric_range_round_trip.bin");
+  const auto ranges = random_ranges<double>(5000, 9, -100);
+  vector<Payload> values(ranges.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = {int32_t(i), float(i) / 2};
+  }
+  write_range_file(file.path, ranges, values);
+
+  const MappedRangeFile<double, Payload> mapped(file.path);
+  REQUIRE(mapped.size() == ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    REQUIRE(compare(mapped.range(i), ranges[i]) == RangeOrdering::equal);
+    REQUIRE(mapped.range(i).lb_inclusive == ranges[i].lb_inclusive);
+    REQUIRE(mapped.range(i).ub_inclusive == ranges[i].ub_inclusive);
+    REQUIRE(mapped.value(i).id == int32_t(i));
+  }
+
+  const RangeMap<double, Payload> map(sorted_unique, ranges, values);
+  for (double x = -101; x < ranges.back().ub + 1; x += 0.25)
+  {
+    const auto expected = map.find(x);
+    const Payload *actual = mapped.find(x);
+    REQUIRE((expected == map.end()) == (actual == nullptr));
+    if (actual != nullptr)
+    {
+      REQUIRE(actual->id == expected->second.id);
+    }
+  }
+}
+
+TEST_CASE("Range file from RangeMap", "[range_file]" ) {
+  TempFile file("numeric_range_map.bin");
+  RangeMap<int64_t, int> map;
+  map.insert({0, true, 10, false}, 1);
+  map.insert({10, false, 20, true}, 2);
+  map.insert({30, true, 30, true}, 3);
+  write_range_file(file.path, map);
+
+  MappedRangeFile<int64_t, int> mapped(file.path);
+  REQUIRE(*mapped.find(0) == 1);
+  REQUIRE(mapped.find(10) == nullptr);
+  REQUIRE(*mapped.find(20) == 2);
+  REQUIRE(*mapped.find(30) == 3);
+  REQUIRE(!mapped.contains(31));
+
+  // Rewriting replaces the file, so an existing mapping keeps its contents
+  RangeMap<int64_t, int> other;
+  other.insert({100, true, 200, true}, 4);
+  write_range_file(file.path, other);
+  REQUIRE(*mapped.find(0) == 1);
+  REQUIRE(mapped.size() == 3);
+  REQUIRE(*MappedRangeFile<int64_t, int>(file.path).find(150) == 4);
+
+  // Moved-from files are empty
+  MappedRangeFile<int64_t, int> moved(std::move(mapped));
+  REQUIRE(moved.size() == 3);
+  REQUIRE(mapped.empty());
+}
+
+TEST_CASE("Range file validation", "[range_file]" ) {
+  TempFile file("numeric_range_invalid.bin");
+  const auto ranges = random_ranges<int>(100, 1);
+  write_range_file(file.path, ranges, vector<int>(ranges.size(), 7));
+  REQUIRE(MappedRangeFile<int, int>(file.path).size() == 100);
+
+  // Type mismatches
+  REQUIRE_THROWS_WITH((MappedRangeFile<int64_t, int>(file.path)),
+                      Catch::Contains("different bound or value type"));
+  REQUIRE_THROWS_AS((MappedRangeFile<unsigned, int>(file.path)),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS((MappedRangeFile<int, double>(file.path)),
+                    std::runtime_error);
+
+  // Corruption
+  {
+    fstream f(file.path, ios::in | ios::out | ios::binary);
+    f.seekp(200);
+    f.put(char(0x5a));
+  }
+  REQUIRE_THROWS_WITH((MappedRangeFile<int, int>(file.path, true)),
+                      Catch::Contains("checksum"));
+  REQUIRE_NOTHROW(MappedRangeFile<int, int>(file.path));
+
+  // Truncation
+  std::filesystem::resize_file(file.path, 300);
+  REQUIRE_THROWS_WITH((MappedRangeFile<int, int>(file.path)),
+                      Catch::Contains("truncated"));
+  REQUIRE_THROWS_AS((MappedRangeFile<int, int>("/nonexistent/ranges.bin")),
+                    std::runtime_error);
+
+  // Writing requires sorted, non-overlapping input
+  vector<NumericRange<int> > overlapping{{0, true, 2, true}, {1, true, 3, true}};
+  REQUIRE_THROWS_AS(write_range_file(file.path, overlapping, vector<int>(2)),
+                    std::runtime_error);
+}
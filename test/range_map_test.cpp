@@ -0,0 +1,203 @@
+#include "catch.hpp"
+#include "../src/range_map.hpp"
+#include "random_ranges.hpp"
+
+#include <map>
+
+using namespace std;
+using namespace numeric_range;
+
+TEST_CASE("RangeMap insertion and ordering", "[range_map]" ) {
+  RangeMap<int, double> map;
+
+  REQUIRE(map.insert({5, false, 6, true}, 5).second);
+  REQUIRE(map.insert({0, true, 1, false}, 0).second);
+  REQUIRE(map.insert({1, false, 3, false}, 1).second);
+  REQUIRE(map.size() == 3);
+
+  // Overlapping ranges are rejected just like with NumericRangeComparator
+  REQUIRE_THROWS_AS(map.insert({1, true, 4, false}, 2), std::runtime_error);
+  REQUIRE_THROWS_AS(map.insert({-1, true, 0, true}, 2), std::runtime_error);
+  REQUIRE(map.size() == 3);
+
+  // Re-inserting an equivalent key does not replace its value
+  auto res = map.insert({0, true, 1, false}, 42);
+  REQUIRE(res.second == false);
+  REQUIRE(res.first->second == 0);
+
+  // Iteration is ordered by range
+  vector<int> lbs;
+  for (const auto &kv : map)
+  {
+    lbs.push_back(kv.first.lb);
+  }
+  REQUIRE(lbs == vector<int>{0, 1, 5});
+}
+
+TEST_CASE("RangeMap scalar lookup", "[range_map]" ) {
+  RangeMap<int, double> map;
+  map.insert({0, true, 1, false}, 0);
+  map.insert({1, false, 3, false}, 1);
+  map.insert({5, false, 6, true}, 5);
+  map.insert({8, true, 8, true}, 8);
+
+  REQUIRE(map.at(0) == 0);
+  REQUIRE(map.at(2) == 1);
+  REQUIRE(map.at(6) == 5);
+  REQUIRE(map.at(8) == 8);
+
+  REQUIRE(map.find(1) == map.end());
+  REQUIRE(map.find(3) == map.end());
+  REQUIRE(map.find(4) == map.end());
+  REQUIRE(map.find(5) == map.end());
+  REQUIRE(map.find(-1) == map.end());
+  REQUIRE(map.find(9) == map.end());
+  REQUIRE_THROWS_AS(map.at(4), std::out_of_range);
+
+  // Lookup with a scalar NumericRange behaves as with std::map
+  REQUIRE(map.find(NumericRange<int>{2})->second == 1);
+  REQUIRE(map.find(NumericRange<int>{4}) == map.end());
+}
+
+TEST_CASE("RangeMap erase", "[range_map]" ) {
+  RangeMap<double, int> map;
+  map.insert({0, true, 1, false}, 0);
+  map.insert({1, true, 2, false}, 1);
+  map.insert({2, true, 3, false}, 2);
+
+  REQUIRE(map.erase(NumericRange<double>{1, true, 2, false}) == 1);
+  REQUIRE(map.erase(NumericRange<double>{1, true, 2, false}) == 0);
+  REQUIRE(map.find(1.5) == map.end());
+  REQUIRE(map.insert({1, true, 1.5, true}, 3).second);
+
+  auto next = map.erase(map.find(0.5));
+  REQUIRE(next->first.lb == 1);
+  REQUIRE(map.size() == 2);
+}
+
+TEST_CASE("RangeMap matches std::map lookups", "[range_map]" ) {
+  std::map<NumericRange<int>, int, NumericRangeComparator<int> > reference;
+  RangeMap<int, int> map;
+  for (const auto &range : random_ranges<int>(500, 7))
+  {
+    const int value = int(map.size());
+    reference.insert({range, value});
+    map.insert(range, value);
+  }
+  const int last = map.keys().back().ub;
+
+  for (int x = -2; x < last + 2; ++x)
+  {
+    auto expected = reference.find(NumericRange<int>{x});
+    auto actual = map.find(x);
+    if (expected == reference.end())
+    {
+      REQUIRE(actual == map.end());
+    }
+    else
+    {
+      REQUIRE(actual != map.end());
+      REQUIRE(actual->second == expected->second);
+    }
+  }
+}
+
+TEST_CASE("RangeMap non-throwing insertion", "[range_map]" ) {
+  RangeMap<int, int> map;
+
+  auto res = map.try_insert({0, true, 2, false}, 0);
+  REQUIRE(res.status == InsertStatus::inserted);
+  res = map.try_insert({4, true, 6, false}, 1);
+  REQUIRE(res.status == InsertStatus::inserted);
+
+  res = map.try_insert({0, true, 2, false}, 2);
+  REQUIRE(res.status == InsertStatus::exists);
+  REQUIRE(res.position->second == 0);
+
+  res = map.try_insert({1, true, 5, false}, 3);
+  REQUIRE(res.status == InsertStatus::overlap);
+  REQUIRE(res.position->first.lb == 0);
+
+  res = map.try_insert({3, true, 5, false}, 3);
+  REQUIRE(res.status == InsertStatus::overlap);
+  REQUIRE(res.position->first.lb == 4);
+
+  res = map.try_insert({2, true, 4, false}, 4);
+  REQUIRE(res.status == InsertStatus::inserted);
+  REQUIRE(map.size() == 3);
+}
+
+TEST_CASE("std::map lookup with a raw scalar", "[range_map]" ) {
+  std::map<NumericRange<int>, int, NumericRangeComparator<int> > map;
+  map.insert({{0, true, 1, false}, 0});
+  map.insert({{1, false, 3, false}, 1});
+  map.insert({{5, false, 6, true}, 5});
+
+  REQUIRE(map.find(0)->second == 0);
+  REQUIRE(map.find(2)->second == 1);
+  REQUIRE(map.find(1) == map.end());
+  REQUIRE(map.find(5) == map.end());
+  REQUIRE(map.lower_bound(4)->second == 5);
+  REQUIRE(map.upper_bound(2)->second == 5);
+  REQUIRE(map.count(6) == 1);
+}
+
+TEST_CASE("RangeMap bulk load from sorted input", "[range_map]" ) {
+  const auto ranges = random_ranges<int>(1000, 11);
+  vector<int> values(ranges.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    values[i] = int(i);
+  }
+
+  RangeMap<int, int> incremental;
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    incremental.insert(ranges[i], values[i]);
+  }
+
+  const RangeMap<int, int> bulk(sorted_unique, ranges, values);
+  REQUIRE(bulk.keys().size() == incremental.keys().size());
+  REQUIRE(std::equal(bulk.values().begin(), bulk.values().end(),
+                     incremental.values().begin()));
+
+  vector<pair<NumericRange<int>, int> > pairs;
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    pairs.emplace_back(ranges[i], values[i]);
+  }
+  const RangeMap<int, int> from_pairs(sorted_unique, pairs.begin(), pairs.end());
+  REQUIRE(from_pairs.values() == bulk.values());
+  for (const auto &kv : pairs)
+  {
+    const int x = detail::closed_lb(kv.first);
+    if (x <= detail::closed_ub(kv.first))
+    {
+      REQUIRE(from_pairs.at(x) == kv.second);
+    }
+  }
+}
+
+TEST_CASE("RangeMap bulk load validation", "[range_map]" ) {
+  vector<NumericRange<int> > keys{
+      {0, true, 1, false}, {1, true, 2, false}, {2, true, 4, false},
+      {3, true, 5, false}, {9, true, 9, true}};
+  REQUIRE(disjoint_sorted_until(keys.begin(), keys.end()) == keys.begin() + 3);
+  REQUIRE_THROWS_WITH(
+      (RangeMap<int, int>(sorted_unique, keys, vector<int>(5))),
+      Catch::Contains("positions 2 and 3"));
+
+  keys.erase(keys.begin() + 3);
+  REQUIRE(disjoint_sorted_until(keys.begin(), keys.end()) == keys.end());
+  REQUIRE_THROWS_AS((RangeMap<int, int>(sorted_unique, keys, vector<int>(5))),
+                    std::invalid_argument);
+  REQUIRE(RangeMap<int, int>(sorted_unique, keys, vector<int>(4)).size() == 4);
+
+  // Duplicates and unsorted input are rejected as well
+  vector<NumericRange<int> > repeated{{0, true, 1, false}, {0, true, 1, false}};
+  REQUIRE(disjoint_sorted_until(repeated.begin(), repeated.end())
+          == repeated.begin() + 1);
+  vector<NumericRange<int> > unsorted{{4, true, 5, false}, {0, true, 1, false}};
+  REQUIRE_THROWS_AS((RangeMap<int, int>(sorted_unique, unsorted, vector<int>(2))),
+                    std::runtime_error);
+}
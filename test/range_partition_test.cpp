@@ -0,0 +1,139 @@
+#include "catch.hpp"
+#include "../src/range_partition.hpp"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+TEST_CASE("RangePartition construction", "[range_partition]" ) {
+  RangePartition<int, string> empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.find(0) == nullptr);
+
+  vector<NumericRange<double> > ranges{
+      {0, true, 10, false}, {10, true, 20, true}, {20, false, 30, true}};
+  RangePartition<double, string> partition(ranges, {"low", "mid", "high"});
+  REQUIRE(partition.size() == 3);
+  REQUIRE(partition.boundary_count() == 4);
+  REQUIRE(partition.side(0) == BoundarySide::right);
+  REQUIRE(partition.side(2) == BoundarySide::left);
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    REQUIRE(compare(partition.bucket(i), ranges[i]) == RangeOrdering::equal);
+  }
+
+  // Ranges must share bounds, with exactly one of them inclusive
+  vector<NumericRange<double> > gap{{0, true, 1, false}, {2, true, 3, true}};
+  REQUIRE_THROWS_AS((RangePartition<double, int>(gap, {0, 1})),
+                    std::runtime_error);
+  vector<NumericRange<double> > both{{0, true, 1, true}, {1, true, 3, true}};
+  REQUIRE_THROWS_AS((RangePartition<double, int>(both, {0, 1})),
+                    std::runtime_error);
+  vector<NumericRange<double> > neither{{0, true, 1, false},
+                                        {1, false, 3, true}};
+  REQUIRE_THROWS_AS((RangePartition<double, int>(neither, {0, 1})),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS((RangePartition<double, int>(ranges, {0, 1})),
+                    std::invalid_argument);
+
+  // From boundaries
+  RangePartition<int, int> bins({0, 10, 20}, {1, 2}, BoundarySide::right);
+  REQUIRE(compare(bins.bucket(1), NumericRange<int>(10, true, 20, false))
+          == RangeOrdering::equal);
+  REQUIRE_THROWS_AS((RangePartition<int, int>({0, 0, 20}, {1, 2},
+                                              BoundarySide::right)),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS((RangePartition<int, int>({0, 10}, {1, 2},
+                                              BoundarySide::right)),
+                    std::invalid_argument);
+}
+
+TEST_CASE("RangePartition lookup", "[range_partition]" ) {
+  const double inf = numeric_limits<double>::infinity();
+  vector<NumericRange<double> > ranges{
+      {-inf, false, 0, false},
+      {0, true, 1, false},
+      {1, true, 1, true},
+      {1, false, 2, true},
+      {2, false, inf, false}};
+  RangePartition<double, int> partition(ranges, {0, 1, 2, 3, 4});
+  const auto npos = RangePartition<double, int>::npos;
+
+  REQUIRE(partition.find_index(-inf) == npos);
+  REQUIRE(partition.find_index(-1) == 0);
+  REQUIRE(partition.find_index(0) == 1);
+  REQUIRE(partition.find_index(nextafter(1.0, 0.0)) == 1);
+  REQUIRE(partition.find_index(1) == 2);
+  REQUIRE(partition.find_index(nextafter(1.0, 2.0)) == 3);
+  REQUIRE(partition.find_index(2) == 3);
+  REQUIRE(partition.find_index(2.5) == 4);
+  REQUIRE(partition.find_index(inf) == npos);
+  REQUIRE(partition.find_index(numeric_limits<double>::quiet_NaN()) == npos);
+  REQUIRE(*partition.find(1) == 2);
+  *partition.find(1) = 7;
+  REQUIRE(partition.value(2) == 7);
+
+  // Compare with a linear scan of the buckets
+  NumericRangeComparator<int> comp;
+  mt19937 gen(5);
+  vector<NumericRange<int> > tiles;
+  int lb = -100;
+  bool lb_incl = true;
+  for (int i = 0; i < 100; ++i)
+  {
+    const int width = int(gen() % 3) + (lb_incl ? 0 : 1);
+    const bool ub_incl = width == 0 || gen() % 2;
+    tiles.emplace_back(lb, lb_incl || width == 0, lb + width, ub_incl);
+    lb += width;
+    lb_incl = !ub_incl;
+  }
+  RangePartition<int, size_t> tiled(tiles, vector<size_t>(tiles.size()));
+  for (int x = -110; x < lb + 10; ++x)
+  {
+    size_t expected = npos;
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+      if (!comp(tiles[i], x) && !comp(x, tiles[i]))
+      {
+        expected = i;
+      }
+    }
+    REQUIRE(tiled.find_index(x) == expected);
+  }
+}
+
+TEST_CASE("RangePartition split and merge", "[range_partition]" ) {
+  RangePartition<int, char> partition({0, 10}, {'a'}, BoundarySide::right);
+
+  REQUIRE(partition.split(5, BoundarySide::left, 'b') == 1);
+  REQUIRE(partition.size() == 2);
+  REQUIRE(compare(partition.bucket(0), NumericRange<int>(0, true, 5, true))
+          == RangeOrdering::equal);
+  REQUIRE(compare(partition.bucket(1), NumericRange<int>(5, false, 10, false))
+          == RangeOrdering::equal);
+  REQUIRE(*partition.find(5) == 'a');
+  REQUIRE(*partition.find(6) == 'b');
+
+  // Neither part may be empty
+  REQUIRE_THROWS_AS(partition.split(0, BoundarySide::right, 'c'),
+                    std::runtime_error);
+  REQUIRE_NOTHROW(partition.split(0, BoundarySide::left, 'c'));
+  REQUIRE(*partition.find(0) == 'a');
+  REQUIRE(*partition.find(1) == 'c');
+  REQUIRE_THROWS_AS(partition.split(10, BoundarySide::left, 'd'),
+                    std::out_of_range);
+
+  partition.merge(0);
+  REQUIRE(partition.size() == 2);
+  REQUIRE(*partition.find(1) == 'a');
+  partition.merge(0);
+  REQUIRE(partition.size() == 1);
+  REQUIRE(compare(partition.bucket(0), NumericRange<int>(0, true, 10, false))
+          == RangeOrdering::equal);
+  REQUIRE_THROWS_AS(partition.merge(0), std::out_of_range);
+}
@@ -0,0 +1,86 @@
+#include "catch.hpp"
+#include "../src/range_set.hpp"
+
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+TEST_CASE("RangeSet merges touching ranges", "[range_set]" ) {
+  RangeSet<double> set;
+  set.insert({0, true, 1, false});
+  set.insert({1, true, 2, false});
+  REQUIRE(set.size() == 1);
+  REQUIRE(set.begin()->lb == 0);
+  REQUIRE(set.begin()->ub == 2);
+  REQUIRE(set.begin()->ub_inclusive == false);
+
+  // (2, 3) leaves a gap at 2, which [2, 2] then fills
+  set.insert({2, false, 3, false});
+  REQUIRE(set.size() == 2);
+  REQUIRE_FALSE(set.contains(2.0));
+  set.insert(NumericRange<double>{2});
+  REQUIRE(set.size() == 1);
+  REQUIRE(set.contains(2.0));
+  REQUIRE_FALSE(set.contains(3.0));
+
+  // A range bridging several components merges all of them
+  set.insert({5, true, 6, true});
+  set.insert({7, true, 8, true});
+  set.insert({10, true, 11, true});
+  REQUIRE(set.size() == 4);
+  set.insert({2.5, true, 7.5, false});
+  REQUIRE(set.size() == 2);
+  REQUIRE(set.contains(NumericRange<double>{0, true, 8, true}));
+  REQUIRE_FALSE(set.contains(NumericRange<double>{0, true, 10, true}));
+}
+
+TEST_CASE("RangeSet integer adjacency", "[range_set]" ) {
+  RangeSet<int> set;
+  set.insert({0, true, 1, true});
+  set.insert({2, true, 3, true});
+  REQUIRE(set.size() == 1);
+
+  // (4, 5) holds no integers, so nothing is inserted
+  REQUIRE(set.insert({4, false, 5, false}) == set.end());
+  REQUIRE(set.size() == 1);
+
+  set.insert({4, false, 6, false});
+  REQUIRE(set.size() == 2);
+  set.insert({4, true, 4, true});
+  REQUIRE(set.size() == 1);
+  REQUIRE(set.contains(NumericRange<int>{0, true, 6, false}));
+}
+
+TEST_CASE("RangeSet matches brute force membership", "[range_set]" ) {
+  mt19937 gen(3);
+  RangeSet<int> set;
+  vector<bool> covered(220, false);
+  for (int i = 0; i < 300; ++i)
+  {
+    const int lb = int(gen() % 200);
+    const int width = int(gen() % 8);
+    const bool lb_incl = width == 0 || gen() % 2;
+    const bool ub_incl = width == 0 || gen() % 2;
+    set.insert({lb, lb_incl, lb + width, ub_incl});
+    for (int x = lb; x <= lb + width; ++x)
+    {
+      if ((x != lb || lb_incl) && (x != lb + width || ub_incl))
+      {
+        covered[size_t(x)] = true;
+      }
+    }
+
+    // Components stay disjoint and non-adjacent
+    for (auto it = set.begin(); it != set.end() && next(it) != set.end(); ++it)
+    {
+      REQUIRE(detail::closed_ub(*it) + 1 < detail::closed_lb(*next(it)));
+    }
+  }
+
+  for (int x = 0; x < 220; ++x)
+  {
+    REQUIRE(set.contains(x) == covered[size_t(x)]);
+  }
+}
@@ -0,0 +1,93 @@
+#include "catch.hpp"
+#include "../src/range_sort.hpp"
+#include "random_ranges.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace std;
+using namespace numeric_range;
+
+namespace {
+
+template<typename T>
+bool
+same_ranges (const vector<NumericRange<T> > &a, const vector<NumericRange<T> > &b)
+{
+  return a.size() == b.size()
+         && std::equal(a.begin(), a.end(), b.begin(),
+                       [] (const NumericRange<T> &l, const NumericRange<T> &r) {
+                         return compare(l, r) == RangeOrdering::equal;
+                       });
+}
+
+template<typename T>
+void
+check_matches_comparator (std::size_t count, unsigned seed)
+{
+  const int start = std::is_signed<T>::value ? -int(count) : 0;
+  const auto expected = random_ranges<T>(count, seed, start);
+  auto ranges = expected;
+  std::shuffle(ranges.begin(), ranges.end(), std::mt19937(seed));
+  sort_ranges(ranges);
+  REQUIRE(same_ranges(ranges, expected));
+}
+
+} /* namespace */
+
+TEST_CASE("Order-preserving keys", "[range_sort]" ) {
+  const double inf = numeric_limits<double>::infinity();
+  const vector<double> doubles{-inf, -1e300, -1.5, -numeric_limits<double>::denorm_min(),
+                               0.0, numeric_limits<double>::denorm_min(), 1.0, 2.5,
+                               1e300, inf};
+  for (size_t i = 1; i < doubles.size(); ++i)
+  {
+    REQUIRE(detail::order_preserving_key(doubles[i - 1])
+            < detail::order_preserving_key(doubles[i]));
+  }
+  REQUIRE(detail::order_preserving_key(-0.0) == detail::order_preserving_key(0.0));
+  REQUIRE(detail::order_preserving_key(-0.0f) == detail::order_preserving_key(0.0f));
+  REQUIRE(detail::order_preserving_key(-1.0f) < detail::order_preserving_key(0.5f));
+
+  const vector<int64_t> ints{numeric_limits<int64_t>::min(), -1, 0, 1,
+                             numeric_limits<int64_t>::max()};
+  for (size_t i = 1; i < ints.size(); ++i)
+  {
+    REQUIRE(detail::order_preserving_key(ints[i - 1])
+            < detail::order_preserving_key(ints[i]));
+  }
+  REQUIRE(detail::order_preserving_key(int8_t(-128)) == 0);
+  REQUIRE(detail::order_preserving_key(int8_t(127)) == 255);
+}
+
+TEST_CASE("sort_ranges matches NumericRangeComparator", "[range_sort]" ) {
+  for (const size_t count : {0, 1, 2, 10, 255, 256, 1000, 20000})
+  {
+    check_matches_comparator<int>(count, unsigned(count));
+    check_matches_comparator<int64_t>(count, unsigned(count) + 1);
+    check_matches_comparator<uint32_t>(count, unsigned(count) + 2);
+    check_matches_comparator<float>(count, unsigned(count) + 3);
+    check_matches_comparator<double>(count, unsigned(count) + 4);
+    check_matches_comparator<long double>(count, unsigned(count) + 5);
+  }
+}
+
+TEST_CASE("sort_ranges bound kinds and special values", "[range_sort]" ) {
+  const double inf = numeric_limits<double>::infinity();
+  const vector<NumericRange<double> > expected{
+      {-inf, false, -2, true}, {-2, false, -1, false}, {-0.5, true, -0.5, true},
+      {-0.5, false, 0, false}, {0, true, 0, true}, {0, false, 1, true},
+      {1, false, inf, true}};
+  auto ranges = expected;
+  std::reverse(ranges.begin(), ranges.end());
+  sort_ranges(ranges);
+  REQUIRE(same_ranges(ranges, expected));
+
+  // Duplicates are kept in their input order
+  vector<NumericRange<int> > dup{{5, true, 6, true}, {0, true, 1, true},
+                                 {5, true, 6, true}};
+  sort_ranges(dup);
+  REQUIRE(dup[0].lb == 0);
+  REQUIRE(disjoint_sorted_until(dup.begin(), dup.end()) == dup.begin() + 2);
+}
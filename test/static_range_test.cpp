@@ -0,0 +1,83 @@
+#include "catch.hpp"
+#include "../src/static_range.hpp"
+
+#include <map>
+#include <vector>
+
+using namespace std;
+using namespace numeric_range;
+
+static_assert(sizeof(HalfOpenRange<double>) == 2 * sizeof(double),
+              "StaticRange must only store its bounds");
+
+TEST_CASE("StaticRange Constructor", "[static_range]" ) {
+  REQUIRE_NOTHROW(HalfOpenRange<int>(0, 1));
+  REQUIRE_THROWS_AS(HalfOpenRange<int>(1, 0), std::runtime_error);
+  REQUIRE_THROWS_AS(HalfOpenRange<int>(0, 0), std::runtime_error);
+  REQUIRE_NOTHROW(ClosedRange<int>(0, 0));
+
+  // Explicit conversions to and from NumericRange
+  const NumericRange<int> runtime(0, true, 1, false);
+  const HalfOpenRange<int> fixed(runtime);
+  REQUIRE(fixed.lb == 0);
+  REQUIRE(fixed.ub == 1);
+  const auto back = NumericRange<int>(fixed);
+  REQUIRE(back.lb_inclusive);
+  REQUIRE_FALSE(back.ub_inclusive);
+  REQUIRE_THROWS_AS(OpenRange<int>(runtime), std::runtime_error);
+}
+
+template<typename L, typename U>
+static void
+check_against_runtime_comparator ()
+{
+  NumericRangeComparator<int> runtime_comp;
+  StaticRangeComparator<int, L, U> comp;
+
+  vector<StaticRange<int, L, U> > ranges;
+  for (int lb = 0; lb < 4; ++lb)
+  {
+    for (int ub = lb; ub < 4; ++ub)
+    {
+      if (NumericRange<int>::is_valid(lb, std::is_same<L, Closed>::value,
+                                      ub, std::is_same<U, Closed>::value))
+      {
+        ranges.emplace_back(lb, ub);
+      }
+    }
+  }
+
+  for (const auto &lhs : ranges)
+  {
+    const auto lhs_runtime = NumericRange<int>(lhs);
+    for (const auto &rhs : ranges)
+    {
+      const auto rhs_runtime = NumericRange<int>(rhs);
+      REQUIRE(comp.compare(lhs, rhs)
+              == runtime_comp.compare(lhs_runtime, rhs_runtime));
+    }
+    for (int x = -1; x < 5; ++x)
+    {
+      REQUIRE(comp(lhs, x) == runtime_comp(lhs_runtime, x));
+      REQUIRE(comp(x, lhs) == runtime_comp(x, lhs_runtime));
+    }
+  }
+}
+
+TEST_CASE("StaticRangeComparator matches NumericRangeComparator", "[static_range]" ) {
+  check_against_runtime_comparator<Closed, Closed>();
+  check_against_runtime_comparator<Closed, Open>();
+  check_against_runtime_comparator<Open, Closed>();
+  check_against_runtime_comparator<Open, Open>();
+}
+
+TEST_CASE("HalfOpenRange as a std::map key", "[static_range]" ) {
+  std::map<HalfOpenRange<double>, int, HalfOpenRangeComparator<double> > map;
+  map.insert({{0, 1}, 0});
+  map.insert({{1, 2}, 1});
+  REQUIRE_THROWS_AS(map.insert({{1.5, 3}, 2}), std::runtime_error);
+
+  REQUIRE(map.find(0.0)->second == 0);
+  REQUIRE(map.find(1.0)->second == 1);
+  REQUIRE(map.find(2.0) == map.end());
+}